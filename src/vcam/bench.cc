@@ -0,0 +1,791 @@
+#include <vcam/core/math.hh>
+#include <vcam/core/profiler.hh>
+#include <vcam/core/scene.hh>
+#include <vcam/render/materials.hh>
+#include <vcam/render/mesh_generation.hh>
+#include <vcam/render/mesh_loader.hh>
+#include <vcam/render/mesh_simplification.hh>
+#include <vcam/render/model.hh>
+#include <vcam/render/offscreen_render_target.hh>
+#include <vcam/render/render_component.hh>
+#include <vcam/render/render_system.hh>
+#include <vcam/render/texture.hh>
+#include <vcam/render/texture_import.hh>
+
+#include <glm/glm.hpp>
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Renders a generated scene headlessly along a scripted camera path and
+// reports per-stage frame time statistics.
+
+// Every heap allocation made by the process, counted by the replaced global
+// operator new below so the bench can check that frames stop allocating.
+static std::atomic<std::size_t> heap_allocations = 0;
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* const pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+struct BenchOptions {
+    std::size_t spheres = 64;
+    std::size_t subdivisions = 3;
+    int width = 1920;
+    int height = 1080;
+    std::size_t frames = 300;
+    std::size_t warmup_frames = 10;
+    std::size_t threads = 0;
+    vcam::ShadingMode shading_mode = vcam::ShadingMode::FORWARD;
+    vcam::Multisampling multisampling = vcam::Multisampling::OFF;
+    bool occlusion_culling = true;
+
+    // Zero orbits just outside the grid of spheres, smaller radii fly
+    // through it with most spheres out of view.
+    float orbit_radius = 0.0f;
+
+    // Submits every sphere in a single add_instances call instead of one
+    // entity per sphere.
+    bool instanced = false;
+
+    float level_of_detail_threshold = 1.0f;
+
+    // Builds the spheres' levels of detail with the quadric simplifier
+    // rather than from lower subdivision counts.
+    bool simplify = false;
+
+    // Point lights with a finite radius spread over the grid of spheres, in
+    // addition to the light following the camera.
+    std::size_t lights = 0;
+
+    float exposure = 1.0f;
+    vcam::ToneMapping tone_mapping = vcam::ToneMapping::CLAMP;
+
+    // Milliseconds of raster time per frame to scale the resolution to,
+    // zero for full resolution.
+    double raster_budget = 0.0;
+
+    // Renders each frame on the render thread while the next one is
+    // updated, reporting the timings and statistics of the frame before.
+    bool pipelined = false;
+
+    // Records the measured frames with the profiler, and writes them to
+    // <trace>.json and <trace>.csv.
+    char const* trace = nullptr;
+
+    // Renders the levels of detail loaded from this file, see
+    // load_levels_of_detail, in place of the spheres.
+    char const* mesh = nullptr;
+
+    // Maps a generated checkerboard, or the BMP file at this path, onto
+    // every sphere, or onto the mesh if it has texture coordinates.
+    char const* texture = nullptr;
+    vcam::TextureFiltering texture_filtering = vcam::TextureFiltering::TRILINEAR;
+};
+
+// Instanced spheres share one model, alternating materials are per-instance
+// overrides. Both have to outlive the instances.
+struct InstancedScene {
+    std::shared_ptr<vcam::Model> model;
+    std::vector<vcam::Material> materials;
+};
+
+// Scale and offset fitting a model into the unit sphere every sphere of the
+// grid fills.
+struct ModelFit {
+    float scale;
+    glm::vec3 offset;
+};
+
+struct Stage {
+    char const* name;
+    double vcam::FrameTimings::* timing;
+};
+
+static bool parse_options(int argc, char* argv[], BenchOptions& options);
+static void print_usage();
+static char const* describe_multisampling(vcam::Multisampling multisampling);
+static char const* describe_texturing(BenchOptions const& options);
+static void build_scene(
+    vcam::Scene& scene,
+    vcam::RenderSystem& render_system,
+    std::vector<vcam::LevelOfDetail> const& levels_of_detail,
+    std::array<vcam::Material, 2> const& materials,
+    BenchOptions const& options
+);
+static void build_instanced_scene(
+    InstancedScene& scene,
+    vcam::RenderSystem& render_system,
+    std::vector<vcam::LevelOfDetail> const& levels_of_detail,
+    std::array<vcam::Material, 2> const& materials,
+    BenchOptions const& options
+);
+static void add_point_lights(vcam::RenderSystem& render_system, BenchOptions const& options);
+static glm::vec3 calculate_sphere_position(std::size_t index, std::size_t count);
+static vcam::LoadedLevelsOfDetail create_levels_of_detail(BenchOptions const& options);
+static std::optional<std::array<vcam::Material, 2>> create_materials(BenchOptions const& options);
+static ModelFit calculate_model_fit(std::vector<vcam::LevelOfDetail> const& levels_of_detail, BenchOptions const& options);
+static vcam::Camera calculate_camera(float t, float orbit_radius);
+static void print_statistics(char const* name, std::vector<double> samples);
+static void print_statistics_row(char const* name, std::vector<double> samples, char const* format);
+static bool write_trace(char const* prefix);
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parse_options(argc, argv, options)) {
+        print_usage();
+        return 1;
+    }
+
+    vcam::RenderSystem render_system(
+        std::make_unique<vcam::OffscreenRenderTarget>(options.width, options.height),
+        options.threads
+    );
+    render_system.shading_mode(options.shading_mode);
+    render_system.multisampling(options.multisampling);
+    render_system.texture_filtering(options.texture_filtering);
+    render_system.occlusion_culling(options.occlusion_culling);
+    render_system.level_of_detail_threshold(options.level_of_detail_threshold);
+    render_system.exposure(options.exposure);
+    render_system.tone_mapping(options.tone_mapping);
+    render_system.raster_budget(options.raster_budget);
+
+    auto const levels_of_detail = create_levels_of_detail(options);
+    if (!levels_of_detail) {
+        return 1;
+    }
+
+    auto const materials = create_materials(options);
+    if (!materials) {
+        return 1;
+    }
+
+    vcam::Scene scene(options.threads);
+    InstancedScene instanced_scene;
+    if (options.instanced) {
+        build_instanced_scene(instanced_scene, render_system, *levels_of_detail, *materials, options);
+    } else {
+        build_scene(scene, render_system, *levels_of_detail, *materials, options);
+    }
+
+    add_point_lights(render_system, options);
+
+    auto const grid_size = std::ceil(std::cbrt(static_cast<float>(options.spheres)));
+    auto const orbit_radius = options.orbit_radius > 0.0f ? options.orbit_radius : grid_size * 3.0f + 6.0f;
+
+    auto const camera_light = render_system.add_light({});
+
+    constexpr std::array<Stage, 9> stages = { {
+        { "begin", &vcam::FrameTimings::begin },
+        { "geometry", &vcam::FrameTimings::geometry },
+        { "clip", &vcam::FrameTimings::clip },
+        { "binning", &vcam::FrameTimings::binning },
+        { "culling", &vcam::FrameTimings::culling },
+        { "raster", &vcam::FrameTimings::raster },
+        { "upscale", &vcam::FrameTimings::upscale },
+        { "present", &vcam::FrameTimings::present },
+        { "total", &vcam::FrameTimings::total },
+    } };
+
+    std::vector<double> update_samples;
+    std::vector<double> frame_samples;
+    std::vector<std::vector<double>> stage_samples(stages.size());
+    std::vector<double> triangle_samples;
+    std::vector<double> rejected_triangle_samples;
+    std::vector<double> accepted_triangle_samples;
+    std::vector<double> clipped_triangle_samples;
+    std::vector<double> back_face_samples;
+    std::vector<double> tested_fragment_samples;
+    std::vector<double> depth_failed_fragment_samples;
+    std::vector<double> shaded_fragment_samples;
+    std::vector<double> overdraw_samples;
+    std::vector<double> allocation_samples;
+    std::vector<double> light_samples;
+    std::vector<double> clustered_light_samples;
+    std::vector<double> frustum_culled_samples;
+    std::vector<double> culled_instance_samples;
+    std::vector<double> culled_triangle_samples;
+    std::vector<double> resolution_scale_samples;
+    std::vector<double> expanded_pixel_samples;
+    std::vector<double> compressed_tile_samples;
+
+    auto const frame_count = options.warmup_frames + options.frames;
+    for (std::size_t frame = 0; frame < frame_count; ++frame) {
+        auto const t = static_cast<float>(frame) / frame_count;
+
+        if (options.trace != nullptr && frame == options.warmup_frames) {
+            vcam::Profiler::instance().enable(true);
+        }
+
+        auto const update_start = std::chrono::steady_clock::now();
+        auto const allocations_before = heap_allocations.load(std::memory_order_relaxed);
+
+        auto const camera = calculate_camera(t, orbit_radius);
+        render_system.camera(camera);
+        render_system.update_light(camera_light, vcam::Light{
+            camera.position + glm::vec3(0.0f, orbit_radius * 0.5f, 0.0f),
+            glm::vec3(0.2f),
+            glm::vec3(1.0f),
+            glm::vec3(0.8f)
+            });
+
+        scene.on_update(0.0f);
+        scene.on_render(1.0f);
+
+        auto const update_end = std::chrono::steady_clock::now();
+
+        if (options.pipelined) {
+            render_system.submit_frame();
+        } else {
+            render_system.render();
+        }
+
+        // Counted over the whole frame, since pipelined frames allocate on
+        // the render thread.
+        auto const frame_end = std::chrono::steady_clock::now();
+        auto const allocations = heap_allocations.load(std::memory_order_relaxed) - allocations_before;
+
+        if (frame < options.warmup_frames) {
+            continue;
+        }
+
+        update_samples.push_back(std::chrono::duration<double, std::milli>(update_end - update_start).count());
+        frame_samples.push_back(std::chrono::duration<double, std::milli>(frame_end - update_start).count());
+
+        auto const& timings = render_system.last_frame_timings();
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            stage_samples[i].push_back(timings.*stages[i].timing);
+        }
+
+        auto const& statistics = render_system.last_frame_statistics();
+        triangle_samples.push_back(static_cast<double>(statistics.submitted_triangles));
+        rejected_triangle_samples.push_back(static_cast<double>(statistics.rejected_triangles));
+        accepted_triangle_samples.push_back(static_cast<double>(statistics.accepted_triangles));
+        clipped_triangle_samples.push_back(static_cast<double>(statistics.clipped_triangles));
+        back_face_samples.push_back(static_cast<double>(statistics.back_faces));
+        tested_fragment_samples.push_back(static_cast<double>(statistics.tested_fragments));
+        depth_failed_fragment_samples.push_back(static_cast<double>(statistics.depth_failed_fragments));
+        shaded_fragment_samples.push_back(static_cast<double>(statistics.shaded_fragments));
+        overdraw_samples.push_back(statistics.overdraw);
+        allocation_samples.push_back(static_cast<double>(allocations));
+        light_samples.push_back(static_cast<double>(statistics.visible_lights));
+        clustered_light_samples.push_back(static_cast<double>(statistics.clustered_lights));
+        frustum_culled_samples.push_back(static_cast<double>(statistics.frustum_culled_instances));
+        culled_instance_samples.push_back(static_cast<double>(statistics.culled_instances));
+        culled_triangle_samples.push_back(static_cast<double>(statistics.culled_triangles));
+        resolution_scale_samples.push_back(statistics.resolution_scale);
+        expanded_pixel_samples.push_back(static_cast<double>(statistics.expanded_pixels));
+        compressed_tile_samples.push_back(static_cast<double>(statistics.compressed_tiles));
+    }
+
+    render_system.finish_frame();
+
+    if (options.trace != nullptr && !write_trace(options.trace)) {
+        return 1;
+    }
+
+    std::printf(
+        "%zu %s spheres, %zu point lights, %zu subdivisions (%s levels of detail within %g px), %dx%d, %zu %s frames, %s shading, %s, %s, occlusion culling %s\n",
+        options.spheres,
+        options.instanced ? "instanced" : "entity",
+        options.lights,
+        options.subdivisions,
+        options.simplify ? "simplified" : "subdivided",
+        options.level_of_detail_threshold,
+        options.width,
+        options.height,
+        options.frames,
+        options.pipelined ? "pipelined" : "serial",
+        options.shading_mode == vcam::ShadingMode::VISIBILITY ? "visibility" : "forward",
+        describe_multisampling(options.multisampling),
+        describe_texturing(options),
+        options.occlusion_culling ? "on" : "off"
+    );
+    std::printf("%-10s %10s %10s %10s\n", "stage [ms]", "min", "median", "p99");
+
+    print_statistics("update", update_samples);
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        print_statistics(stages[i].name, stage_samples[i]);
+    }
+    print_statistics("frame", frame_samples);
+
+    std::printf("\n%-10s %10s %10s %10s\n", "per frame", "min", "median", "p99");
+    print_statistics_row("triangles", triangle_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("rejected", rejected_triangle_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("accepted", accepted_triangle_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("clipped", clipped_triangle_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("back faces", back_face_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("tested", tested_fragment_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("depth fail", depth_failed_fragment_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("shaded", shaded_fragment_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("overdraw", overdraw_samples, "%-10s %10.3f %10.3f %10.3f\n");
+    print_statistics_row("heap allocs", allocation_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("lights", light_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("light list", clustered_light_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("frustum inst", frustum_culled_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("culled inst", culled_instance_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("culled tris", culled_triangle_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("res scale", resolution_scale_samples, "%-10s %10.3f %10.3f %10.3f\n");
+    print_statistics_row("expanded px", expanded_pixel_samples, "%-10s %10.0f %10.0f %10.0f\n");
+    print_statistics_row("compr tiles", compressed_tile_samples, "%-10s %10.0f %10.0f %10.0f\n");
+
+    auto const& arena = render_system.frame_arena();
+    std::printf(
+        "\nframe arena: %zu KiB capacity, %zu KiB high-water mark, %zu blocks allocated\n",
+        arena.capacity() / 1024,
+        arena.high_water_mark() / 1024,
+        arena.block_allocations()
+    );
+
+    return 0;
+}
+
+bool parse_options(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+
+        auto const* const name = argv[i];
+        auto const* const argument = argv[++i];
+
+        if (std::strcmp(name, "--shading") == 0) {
+            if (std::strcmp(argument, "forward") == 0) {
+                options.shading_mode = vcam::ShadingMode::FORWARD;
+            } else if (std::strcmp(argument, "visibility") == 0) {
+                options.shading_mode = vcam::ShadingMode::VISIBILITY;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown shading mode: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--lod") == 0) {
+            options.level_of_detail_threshold = std::strtof(argument, nullptr);
+            if (options.level_of_detail_threshold < 0.0f) {
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--exposure") == 0) {
+            options.exposure = std::strtof(argument, nullptr);
+            if (options.exposure < 0.0f) {
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--raster-budget") == 0) {
+            options.raster_budget = std::strtod(argument, nullptr);
+            if (options.raster_budget < 0.0) {
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--trace") == 0) {
+            options.trace = argument;
+            continue;
+        }
+
+        if (std::strcmp(name, "--mesh") == 0) {
+            options.mesh = argument;
+            continue;
+        }
+
+        if (std::strcmp(name, "--texture") == 0) {
+            options.texture = argument;
+            continue;
+        }
+
+        if (std::strcmp(name, "--filtering") == 0) {
+            if (std::strcmp(argument, "bilinear") == 0) {
+                options.texture_filtering = vcam::TextureFiltering::BILINEAR;
+            } else if (std::strcmp(argument, "trilinear") == 0) {
+                options.texture_filtering = vcam::TextureFiltering::TRILINEAR;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown texture filtering: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--tone-mapping") == 0) {
+            if (std::strcmp(argument, "clamp") == 0) {
+                options.tone_mapping = vcam::ToneMapping::CLAMP;
+            } else if (std::strcmp(argument, "reinhard") == 0) {
+                options.tone_mapping = vcam::ToneMapping::REINHARD;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown tone mapping: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--simplify") == 0) {
+            if (std::strcmp(argument, "on") == 0) {
+                options.simplify = true;
+            } else if (std::strcmp(argument, "off") == 0) {
+                options.simplify = false;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown simplification setting: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--instanced") == 0) {
+            if (std::strcmp(argument, "on") == 0) {
+                options.instanced = true;
+            } else if (std::strcmp(argument, "off") == 0) {
+                options.instanced = false;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown instancing setting: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--pipelined") == 0) {
+            if (std::strcmp(argument, "on") == 0) {
+                options.pipelined = true;
+            } else if (std::strcmp(argument, "off") == 0) {
+                options.pipelined = false;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown pipelining setting: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--msaa") == 0) {
+            if (std::strcmp(argument, "off") == 0) {
+                options.multisampling = vcam::Multisampling::OFF;
+            } else if (std::strcmp(argument, "4") == 0) {
+                options.multisampling = vcam::Multisampling::X4;
+            } else if (std::strcmp(argument, "8") == 0) {
+                options.multisampling = vcam::Multisampling::X8;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown multisampling setting: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        if (std::strcmp(name, "--occlusion") == 0) {
+            if (std::strcmp(argument, "on") == 0) {
+                options.occlusion_culling = true;
+            } else if (std::strcmp(argument, "off") == 0) {
+                options.occlusion_culling = false;
+            } else {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown occlusion culling setting: %s", argument);
+                return false;
+            }
+            continue;
+        }
+
+        auto const value = std::strtoll(argument, nullptr, 10);
+        if (value < 0) {
+            return false;
+        }
+
+        if (std::strcmp(name, "--spheres") == 0) {
+            options.spheres = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--subdivisions") == 0) {
+            options.subdivisions = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--width") == 0) {
+            options.width = static_cast<int>(value);
+        } else if (std::strcmp(name, "--height") == 0) {
+            options.height = static_cast<int>(value);
+        } else if (std::strcmp(name, "--frames") == 0) {
+            options.frames = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--warmup") == 0) {
+            options.warmup_frames = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--threads") == 0) {
+            options.threads = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--lights") == 0) {
+            options.lights = static_cast<std::size_t>(value);
+        } else if (std::strcmp(name, "--orbit") == 0) {
+            options.orbit_radius = static_cast<float>(value);
+        } else {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown option: %s", name);
+            return false;
+        }
+    }
+
+    return options.width > 0 && options.height > 0 && options.frames > 0;
+}
+
+void print_usage() {
+    std::printf(
+        "usage: vcam_bench [--spheres N] [--subdivisions N] [--width N] [--height N]\n"
+        "                  [--frames N] [--warmup N] [--threads N] [--shading forward|visibility]\n"
+        "                  [--occlusion on|off] [--orbit N] [--instanced on|off]\n"
+        "                  [--lod PIXELS] [--simplify on|off] [--exposure SCALE]\n"
+        "                  [--tone-mapping clamp|reinhard] [--lights N] [--pipelined on|off]\n"
+        "                  [--raster-budget MS] [--trace PREFIX] [--mesh PATH]\n"
+        "                  [--msaa off|4|8] [--texture checkerboard|PATH.bmp]\n"
+        "                  [--filtering bilinear|trilinear]\n"
+    );
+}
+
+char const* describe_multisampling(vcam::Multisampling multisampling) {
+    switch (multisampling) {
+    case vcam::Multisampling::X4:
+        return "4x multisampling";
+
+    case vcam::Multisampling::X8:
+        return "8x multisampling";
+
+    default:
+        return "no multisampling";
+    }
+}
+
+char const* describe_texturing(BenchOptions const& options) {
+    if (options.texture == nullptr) {
+        return "untextured";
+    }
+
+    return options.texture_filtering == vcam::TextureFiltering::BILINEAR ? "bilinear textures" : "trilinear textures";
+}
+
+void build_scene(
+    vcam::Scene& scene,
+    vcam::RenderSystem& render_system,
+    std::vector<vcam::LevelOfDetail> const& levels_of_detail,
+    std::array<vcam::Material, 2> const& materials,
+    BenchOptions const& options
+) {
+    auto const fit = calculate_model_fit(levels_of_detail, options);
+
+    std::array<std::shared_ptr<vcam::Model>, 2> const models = {
+        std::make_shared<vcam::Model>(levels_of_detail, materials[0]),
+        std::make_shared<vcam::Model>(levels_of_detail, materials[1]),
+    };
+
+    auto& transforms = scene.transforms();
+    auto& renders = scene.add_pool<vcam::RenderComponents>(render_system);
+    scene.add_system(std::make_unique<vcam::RenderComponentSystem>());
+
+    for (std::size_t i = 0; i < options.spheres; ++i) {
+        auto const entity = scene.create_entity();
+        transforms.insert(
+            entity,
+            calculate_sphere_position(i, options.spheres) + fit.offset,
+            glm::vec3(0.0f),
+            glm::vec3(fit.scale)
+        );
+        renders.insert(entity, models[i % models.size()]);
+    }
+}
+
+void build_instanced_scene(
+    InstancedScene& scene,
+    vcam::RenderSystem& render_system,
+    std::vector<vcam::LevelOfDetail> const& levels_of_detail,
+    std::array<vcam::Material, 2> const& materials,
+    BenchOptions const& options
+) {
+    auto const fit = calculate_model_fit(levels_of_detail, options);
+
+    scene.model = std::make_shared<vcam::Model>(levels_of_detail, materials[0]);
+
+    std::vector<glm::mat4> transforms;
+    for (std::size_t i = 0; i < options.spheres; ++i) {
+        transforms.push_back(vcam::calculate_transform_matrix(
+            calculate_sphere_position(i, options.spheres) + fit.offset,
+            glm::vec3(0.0f),
+            glm::vec3(fit.scale)
+        ));
+        scene.materials.push_back(materials[i % materials.size()]);
+    }
+
+    render_system.add_instances(*scene.model, transforms, scene.materials);
+}
+
+// Loading is timed, as it would stall startup if it weren't done in the
+// background.
+vcam::LoadedLevelsOfDetail create_levels_of_detail(BenchOptions const& options) {
+    if (options.mesh != nullptr) {
+        auto const start = std::chrono::steady_clock::now();
+        auto levels_of_detail = vcam::load_levels_of_detail(options.mesh);
+        auto const end = std::chrono::steady_clock::now();
+
+        if (levels_of_detail) {
+            std::printf(
+                "loaded %s, %zu triangles in %zu levels of detail, in %.2f ms\n",
+                options.mesh,
+                levels_of_detail->front().mesh.triangles().size(),
+                levels_of_detail->size(),
+                std::chrono::duration<double, std::milli>(end - start).count()
+            );
+        }
+        return levels_of_detail;
+    }
+
+    auto const texture_coordinates = options.texture != nullptr;
+    if (options.simplify) {
+        return vcam::generate_levels_of_detail(vcam::generate_sphere_mesh(options.subdivisions, texture_coordinates));
+    }
+
+    return vcam::generate_sphere_levels_of_detail(options.subdivisions, texture_coordinates);
+}
+
+// Spheres alternate between gold and plastic, textured ones all share one
+// material, so the texture's colors show as they are.
+std::optional<std::array<vcam::Material, 2>> create_materials(BenchOptions const& options) {
+    if (options.texture == nullptr) {
+        return std::array<vcam::Material, 2>{ vcam::create_gold_material(), vcam::create_plastic_material() };
+    }
+
+    std::shared_ptr<vcam::Texture const> texture;
+    if (std::strcmp(options.texture, "checkerboard") == 0) {
+        texture = std::make_shared<vcam::Texture const>(
+            vcam::generate_checkerboard_texture(512, 16, glm::vec3(0.9f, 0.9f, 0.85f), glm::vec3(0.1f, 0.2f, 0.6f))
+        );
+    } else if (auto imported = vcam::import_bmp(options.texture)) {
+        texture = std::make_shared<vcam::Texture const>(std::move(*imported));
+    } else {
+        return std::nullopt;
+    }
+
+    return std::array<vcam::Material, 2>{ vcam::create_textured_material(texture), vcam::create_textured_material(texture) };
+}
+
+// Spheres already fill the unit sphere.
+ModelFit calculate_model_fit(std::vector<vcam::LevelOfDetail> const& levels_of_detail, BenchOptions const& options) {
+    auto const& bounding_sphere = levels_of_detail.front().mesh.bounding_sphere();
+    if (options.mesh == nullptr || bounding_sphere.radius <= 0.0f) {
+        return { 1.0f, glm::vec3(0.0f) };
+    }
+
+    auto const scale = 1.0f / bounding_sphere.radius;
+    return { scale, -bounding_sphere.center * scale };
+}
+
+void add_point_lights(vcam::RenderSystem& render_system, BenchOptions const& options) {
+    if (options.lights == 0) {
+        return;
+    }
+
+    std::array<glm::vec3, 4> const colors = {
+        glm::vec3(1.0f, 0.3f, 0.2f),
+        glm::vec3(0.2f, 1.0f, 0.3f),
+        glm::vec3(0.3f, 0.4f, 1.0f),
+        glm::vec3(1.0f, 0.9f, 0.5f),
+    };
+
+    // Lights sit on their own grid spanning the spheres', and reach a bit
+    // further than their spacing so that neighboring lights overlap.
+    auto const sphere_grid_size = std::ceil(std::cbrt(static_cast<float>(options.spheres)));
+    auto const light_grid_size = std::ceil(std::cbrt(static_cast<float>(options.lights)));
+    auto const scale = sphere_grid_size / light_grid_size;
+
+    for (std::size_t i = 0; i < options.lights; ++i) {
+        auto const& color = colors[i % colors.size()];
+        render_system.add_light({
+            calculate_sphere_position(i, options.lights) * scale,
+            glm::vec3(0.0f),
+            color * 0.5f,
+            color,
+            3.0f * scale * 1.5f
+            });
+    }
+}
+
+glm::vec3 calculate_sphere_position(std::size_t index, std::size_t count) {
+    // Spheres are laid out on a cubic grid centered on the origin.
+    auto const grid_size = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<float>(count))));
+    auto const spacing = 3.0f;
+    auto const offset = (static_cast<float>(grid_size) - 1.0f) * spacing * 0.5f;
+
+    auto const x = index % grid_size;
+    auto const y = (index / grid_size) % grid_size;
+    auto const z = index / (grid_size * grid_size);
+
+    return glm::vec3(x, y, z) * spacing - glm::vec3(offset);
+}
+
+vcam::Camera calculate_camera(float t, float orbit_radius) {
+    // One full orbit around the origin over the run, bobbing up and down.
+    auto const yaw = t * 2.0f * std::numbers::pi_v<float>;
+    auto const pitch = 0.3f * std::sin(t * 4.0f * std::numbers::pi_v<float>);
+
+    auto const forward = glm::vec3(
+        std::sin(yaw) * std::cos(pitch),
+        -std::sin(pitch),
+        std::cos(yaw) * std::cos(pitch)
+    );
+
+    return {
+        .position = -forward * orbit_radius,
+        .rotation = glm::vec3(pitch, yaw, 0.0f),
+        .vfov = 60.0f
+    };
+}
+
+void print_statistics(char const* name, std::vector<double> samples) {
+    print_statistics_row(name, std::move(samples), "%-10s %10.3f %10.3f %10.3f\n");
+}
+
+void print_statistics_row(char const* name, std::vector<double> samples, char const* format) {
+    std::sort(samples.begin(), samples.end());
+
+    auto const min = samples.front();
+    auto const median = samples[samples.size() / 2];
+    auto const p99_index = static_cast<std::size_t>(std::ceil(samples.size() * 0.99)) - 1;
+    auto const p99 = samples[std::min(p99_index, samples.size() - 1)];
+
+    std::printf(format, name, min, median, p99);
+}
+
+// Every frame is finished by now, so no thread is recording.
+bool write_trace(char const* prefix) {
+    auto& profiler = vcam::Profiler::instance();
+    profiler.enable(false);
+
+    auto const json_path = std::string(prefix) + ".json";
+    std::ofstream json(json_path);
+    profiler.write_chrome_trace(json);
+
+    auto const csv_path = std::string(prefix) + ".csv";
+    std::ofstream csv(csv_path);
+    profiler.write_csv(csv);
+
+    if (!json || !csv) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write the trace to %s and %s", json_path.c_str(), csv_path.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#include <vcam/core/component_pool.hh>
+
+namespace vcam {
+
+std::size_t ComponentPool::insert_entity(Entity entity) {
+    if (entity.index >= m_indices.size()) {
+        m_indices.resize(static_cast<std::size_t>(entity.index) + 1, ABSENT);
+    }
+
+    auto const index = m_entities.size();
+    m_indices[entity.index] = static_cast<std::uint32_t>(index);
+    m_entities.push_back(entity);
+
+    return index;
+}
+
+std::size_t ComponentPool::remove_entity(Entity entity) {
+    auto const index = m_indices[entity.index];
+    auto const last = m_entities.back();
+
+    m_entities[index] = last;
+    m_indices[last.index] = index;
+
+    m_entities.pop_back();
+    m_indices[entity.index] = ABSENT;
+
+    return index;
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vcam/core/entity.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace vcam {
+
+// Components of a single type for every entity having one. Pools keep each
+// field of their components in an array of its own, packed without gaps, so
+// systems walk them linearly. This base maps entities to indices into those
+// arrays, which stay valid until a component is removed.
+class ComponentPool {
+public:
+    virtual ~ComponentPool() = default;
+
+    ComponentPool() = default;
+
+    ComponentPool(ComponentPool const& other) = delete;
+    ComponentPool& operator=(ComponentPool const& other) = delete;
+
+    bool contains(Entity entity) const {
+        return entity.index < m_indices.size() &&
+            m_indices[entity.index] != ABSENT &&
+            m_entities[m_indices[entity.index]] == entity;
+    }
+
+    // Index of the entity's component, which it has to have.
+    std::size_t index(Entity entity) const {
+        return m_indices[entity.index];
+    }
+
+    std::size_t size() const {
+        return m_entities.size();
+    }
+
+    // Entity owning each component, in the order of the arrays.
+    std::span<Entity const> entities() const {
+        return m_entities;
+    }
+
+    // Removes the entity's component, if it has one.
+    virtual void remove(Entity entity) = 0;
+
+protected:
+    // Adds the entity, which mustn't have a component yet. Its component
+    // goes at the returned index, which is the end of the arrays.
+    std::size_t insert_entity(Entity entity);
+
+    // Removes the entity, which has to have a component. The last component
+    // takes its place, so the arrays have to move their last element to the
+    // returned index and drop the last one, see remove_swapped().
+    std::size_t remove_entity(Entity entity);
+
+private:
+    static constexpr std::uint32_t ABSENT = ~std::uint32_t(0);
+
+    // Component index by entity index.
+    std::vector<std::uint32_t> m_indices;
+    std::vector<Entity> m_entities;
+};
+
+// Moves the last element of every array to index and drops the last one.
+template <typename... Arrays>
+void remove_swapped(std::size_t index, Arrays&... arrays) {
+    ((arrays[index] = std::move(arrays.back()), arrays.pop_back()), ...);
+}
+
+}
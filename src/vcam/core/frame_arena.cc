@@ -0,0 +1,76 @@
+#include <vcam/core/frame_arena.hh>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+namespace vcam {
+
+static constexpr std::size_t MIN_BLOCK_SIZE = 64 * 1024;
+
+FrameArena::FrameArena(std::size_t initial_capacity) {
+    if (initial_capacity > 0) {
+        add_block(initial_capacity);
+    }
+}
+
+FrameArena::~FrameArena() {
+    release_blocks();
+}
+
+void FrameArena::reset() {
+    m_high_water_mark = std::max(m_high_water_mark, m_frame_bytes);
+    m_frame_bytes = 0;
+    m_offset = 0;
+
+    if (m_blocks.size() > 1) {
+        auto const capacity = m_capacity;
+        release_blocks();
+        add_block(capacity);
+    }
+}
+
+void* FrameArena::do_allocate(std::size_t bytes, std::size_t alignment) {
+    auto const fits = [&](Block const& block, std::size_t& padding) {
+        auto const address = reinterpret_cast<std::uintptr_t>(block.data) + m_offset;
+        padding = (alignment - address % alignment) % alignment;
+        return m_offset + padding + bytes <= block.size;
+        };
+
+    std::size_t padding = 0;
+    if (m_blocks.empty() || !fits(m_blocks.back(), padding)) {
+        // Growing by the whole capacity keeps the number of blocks chained
+        // within a frame logarithmic in its size.
+        add_block(std::max({ bytes + alignment, m_capacity, MIN_BLOCK_SIZE }));
+        m_offset = 0;
+        fits(m_blocks.back(), padding);
+    }
+
+    auto* const pointer = m_blocks.back().data + m_offset + padding;
+    m_offset += padding + bytes;
+    m_frame_bytes += padding + bytes;
+
+    return pointer;
+}
+
+void FrameArena::do_deallocate(void*, std::size_t, std::size_t) { }
+
+bool FrameArena::do_is_equal(std::pmr::memory_resource const& other) const noexcept {
+    return this == &other;
+}
+
+void FrameArena::add_block(std::size_t size) {
+    m_blocks.push_back({ static_cast<std::byte*>(::operator new(size)), size });
+    m_capacity += size;
+    ++m_block_allocations;
+}
+
+void FrameArena::release_blocks() {
+    for (auto const& block : m_blocks) {
+        ::operator delete(block.data);
+    }
+    m_blocks.clear();
+    m_capacity = 0;
+}
+
+}
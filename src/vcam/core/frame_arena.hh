@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace vcam {
+
+// Linear allocator for memory which lives until the end of a frame.
+// Deallocation is a no-op, everything is released at once by reset().
+//
+// When a frame outgrows the current block another one is chained on. The
+// next reset() merges them into a single block, so after a few frames the
+// arena settles at the frame's high-water mark and stops touching the heap.
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(std::size_t initial_capacity = 0);
+    ~FrameArena() override;
+
+    FrameArena(FrameArena const& other) = delete;
+    FrameArena& operator=(FrameArena const& other) = delete;
+
+    // Invalidates everything allocated since the previous reset.
+    void reset();
+
+    // Bytes available to a frame without growing.
+    std::size_t capacity() const {
+        return m_capacity;
+    }
+
+    // Most bytes handed out during a single frame so far.
+    std::size_t high_water_mark() const {
+        return m_high_water_mark;
+    }
+
+    // Blocks requested from the heap since construction.
+    std::size_t block_allocations() const {
+        return m_block_allocations;
+    }
+
+private:
+    struct Block {
+        std::byte* data;
+        std::size_t size;
+    };
+
+    std::vector<Block> m_blocks;
+    std::size_t m_offset = 0;
+    std::size_t m_capacity = 0;
+    std::size_t m_frame_bytes = 0;
+    std::size_t m_high_water_mark = 0;
+    std::size_t m_block_allocations = 0;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+    bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+    void add_block(std::size_t size);
+    void release_blocks();
+};
+
+}
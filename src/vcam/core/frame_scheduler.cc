@@ -0,0 +1,62 @@
+#include <vcam/core/frame_scheduler.hh>
+
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace vcam {
+
+// Sleeps end this long before the deadline, which covers the oversleep of
+// common timers, and the rest is spun away.
+static constexpr std::uint64_t SPIN_TIME = 2 * SDL_NS_PER_MS;
+
+FrameScheduler::FrameScheduler(std::uint64_t step_time, double frame_rate)
+    : m_step_time(std::max<std::uint64_t>(step_time, 1)), m_frame_start(SDL_GetTicksNS()) {
+    this->frame_rate(frame_rate);
+}
+
+void FrameScheduler::frame_rate(double frame_rate) {
+    m_frame_rate = std::max(frame_rate, 0.0);
+    m_frame_time = m_frame_rate > 0.0 ? static_cast<std::uint64_t>(SDL_NS_PER_SECOND / m_frame_rate) : 0;
+}
+
+std::uint32_t FrameScheduler::begin_frame() {
+    auto const now = SDL_GetTicksNS();
+    auto const elapsed = now - m_frame_start;
+
+    if (!m_first_frame) {
+        m_sample.frame_time = elapsed;
+        m_history.push(m_sample);
+    }
+    m_first_frame = false;
+    m_frame_start = now;
+
+    m_accumulator += std::min(elapsed, MAX_STEPS_PER_FRAME * m_step_time);
+
+    auto const steps = static_cast<std::uint32_t>(m_accumulator / m_step_time);
+    m_accumulator -= steps * m_step_time;
+
+    m_sample.steps = steps;
+    return steps;
+}
+
+void FrameScheduler::end_frame() {
+    auto now = SDL_GetTicksNS();
+    m_sample.work_time = now - m_frame_start;
+
+    if (m_frame_time == 0) {
+        return;
+    }
+
+    auto const deadline = m_frame_start + m_frame_time;
+    if (now + SPIN_TIME < deadline) {
+        SDL_DelayNS(deadline - now - SPIN_TIME);
+    }
+
+    while (SDL_GetTicksNS() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+}
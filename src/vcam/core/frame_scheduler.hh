@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vcam {
+
+// Times of one frame, in nanoseconds.
+struct FrameTimeSample {
+    // From the start of the frame to the start of the next one.
+    std::uint64_t frame_time;
+
+    // From the start of the frame until it was done, before pacing.
+    std::uint64_t work_time;
+
+    std::uint32_t steps;
+};
+
+// The most recent frame times, each new sample replacing the oldest once
+// it's full.
+class FrameTimeHistory {
+public:
+    static constexpr std::size_t CAPACITY = 256;
+
+    void push(FrameTimeSample const& sample) {
+        m_samples[m_next] = sample;
+        m_next = (m_next + 1) % CAPACITY;
+        if (m_size < CAPACITY) {
+            ++m_size;
+        }
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    // Sample 0 is the oldest one.
+    FrameTimeSample const& operator[](std::size_t index) const {
+        return m_samples[(m_next + CAPACITY - m_size + index) % CAPACITY];
+    }
+
+private:
+    std::array<FrameTimeSample, CAPACITY> m_samples{};
+    std::size_t m_next = 0;
+    std::size_t m_size = 0;
+};
+
+// Paces the main loop. The simulation advances in fixed steps, as many per
+// frame as have come due, and frames are drawn between the last two steps,
+// so simulation speed doesn't depend on the frame rate. Capped frames wait
+// out the rest of their time by sleeping, then spinning for the last bit,
+// since sleeps tend to overshoot.
+class FrameScheduler {
+public:
+    // At most this many steps are run per frame, so after a stall the
+    // simulation skips ahead instead of trying to catch up.
+    static constexpr std::uint32_t MAX_STEPS_PER_FRAME = 8;
+
+    // Steps take step_time nanoseconds. A frame rate of zero is uncapped.
+    explicit FrameScheduler(std::uint64_t step_time, double frame_rate = 0.0);
+
+    // Starts a frame, returning how many steps to run before drawing it.
+    std::uint32_t begin_frame();
+
+    // Waits until the frame's time is up, unless frames are uncapped.
+    void end_frame();
+
+    // How far real time has moved past the last step, in steps from 0 to 1.
+    // Frames are drawn this far between the last two steps.
+    float interpolation() const {
+        return static_cast<float>(m_accumulator) / m_step_time;
+    }
+
+    std::uint64_t step_time() const {
+        return m_step_time;
+    }
+
+    void frame_rate(double frame_rate);
+
+    double frame_rate() const {
+        return m_frame_rate;
+    }
+
+    FrameTimeHistory const& history() const {
+        return m_history;
+    }
+
+private:
+    std::uint64_t m_step_time;
+    double m_frame_rate = 0.0;
+
+    // Zero when uncapped.
+    std::uint64_t m_frame_time = 0;
+
+    std::uint64_t m_frame_start;
+    std::uint64_t m_accumulator = 0;
+    FrameTimeSample m_sample{};
+    bool m_first_frame = true;
+
+    FrameTimeHistory m_history;
+};
+
+}
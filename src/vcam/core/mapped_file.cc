@@ -0,0 +1,110 @@
+#include <vcam/core/mapped_file.hh>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace vcam {
+
+// Smallest page size of the supported platforms, so that touching a byte
+// this far apart touches every page.
+static constexpr std::size_t PAGE_SIZE = 4096;
+
+#ifdef _WIN32
+
+std::shared_ptr<MappedFile const> MappedFile::open(std::filesystem::path const& path) {
+    auto const file = CreateFileW(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // The view keeps the mapping and the file open once it's created.
+    auto const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return nullptr;
+    }
+
+    auto const* const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        return nullptr;
+    }
+
+    return std::shared_ptr<MappedFile const>(new MappedFile(
+        static_cast<std::byte const*>(data),
+        static_cast<std::size_t>(size.QuadPart)
+    ));
+}
+
+MappedFile::~MappedFile() {
+    UnmapViewOfFile(m_data);
+}
+
+#else
+
+std::shared_ptr<MappedFile const> MappedFile::open(std::filesystem::path const& path) {
+    auto const file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return nullptr;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size <= 0) {
+        close(file);
+        return nullptr;
+    }
+
+    // The mapping keeps the file open once it's created.
+    auto const size = static_cast<std::size_t>(status.st_size);
+    auto* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return nullptr;
+    }
+
+    return std::shared_ptr<MappedFile const>(new MappedFile(static_cast<std::byte const*>(data), size));
+}
+
+MappedFile::~MappedFile() {
+    munmap(const_cast<std::byte*>(m_data), m_size);
+}
+
+#endif
+
+// The advice starts reading every page at once rather than one fault at a
+// time, touching the pages then waits for them.
+void MappedFile::prefetch() const {
+#ifndef _WIN32
+    posix_madvise(const_cast<std::byte*>(m_data), m_size, POSIX_MADV_WILLNEED);
+#endif
+
+    // Read through a volatile pointer, so the reads aren't optimized away.
+    auto const* const bytes = reinterpret_cast<unsigned char const volatile*>(m_data);
+    for (std::size_t offset = 0; offset < m_size; offset += PAGE_SIZE) {
+        static_cast<void>(bytes[offset]);
+    }
+}
+
+}
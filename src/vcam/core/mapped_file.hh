@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+
+namespace vcam {
+
+// Read-only mapping of a whole file into memory. Pages are read in from the
+// file as they're first accessed, and the system can drop them again under
+// memory pressure, as they're backed by the file rather than swap.
+class MappedFile {
+public:
+    // Returns null if the file can't be opened or mapped, which includes
+    // empty files.
+    static std::shared_ptr<MappedFile const> open(std::filesystem::path const& path);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile const& other) = delete;
+    MappedFile& operator=(MappedFile const& other) = delete;
+
+    std::byte const* data() const {
+        return m_data;
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    // Reads every page in ahead of its first access, so that the thread
+    // accessing the file later doesn't wait for the disk.
+    void prefetch() const;
+
+private:
+    std::byte const* m_data;
+    std::size_t m_size;
+
+    MappedFile(std::byte const* data, std::size_t size) : m_data(data), m_size(size) { }
+};
+
+}
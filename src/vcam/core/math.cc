@@ -1,8 +1,21 @@
 #include <vcam/core/math.hh>
 
+#include <cmath>
+
 glm::mat4 vcam::calculate_transform_matrix(glm::vec3 const& translation, glm::vec3 const& rotation, glm::vec3 const& scale) {
     auto const rotation_matrix = glm::yawPitchRoll(rotation.y, rotation.x, rotation.z);
     auto const translation_matrix = glm::translate(translation);
     auto const scale_matrix = glm::scale(scale);
     return translation_matrix * rotation_matrix * scale_matrix;
 }
+
+glm::vec3 vcam::interpolate_angles(glm::vec3 const& from, glm::vec3 const& to, float t) {
+    constexpr auto full_turn = 2.0f * std::numbers::pi_v<float>;
+
+    auto const delta = glm::vec3(
+        std::remainder(to.x - from.x, full_turn),
+        std::remainder(to.y - from.y, full_turn),
+        std::remainder(to.z - from.z, full_turn)
+    );
+    return from + delta * t;
+}
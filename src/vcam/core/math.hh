@@ -12,6 +12,10 @@ namespace vcam {
 
 glm::mat4 calculate_transform_matrix(glm::vec3 const& translation, glm::vec3 const& rotation, glm::vec3 const& scale);
 
+// Interpolates Euler angles the shorter way around, so that an angle
+// wrapping from pi to -pi doesn't turn all the way back.
+glm::vec3 interpolate_angles(glm::vec3 const& from, glm::vec3 const& to, float t);
+
 constexpr float to_radians(float degrees) {
     return degrees * std::numbers::pi / 180.0f;
 }
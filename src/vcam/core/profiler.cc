@@ -0,0 +1,100 @@
+#include <vcam/core/profiler.hh>
+
+#include <iomanip>
+#include <ostream>
+
+namespace vcam {
+
+// Events each thread has room for before its buffer grows.
+static constexpr std::size_t INITIAL_THREAD_EVENTS = 1 << 14;
+
+static double to_microseconds(std::uint64_t nanoseconds);
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::record_scope(char const* name, std::uint64_t start, std::uint64_t end) {
+    thread_buffer().events.push_back({ ProfileEventType::SCOPE, name, start, end - start, 0.0 });
+}
+
+void Profiler::record_counter(char const* name, double value) {
+    thread_buffer().events.push_back({ ProfileEventType::COUNTER, name, now(), 0, value });
+}
+
+// Times are written with a fixed nanosecond precision, as the default
+// one turns to exponents within a few seconds of microseconds.
+void Profiler::write_chrome_trace(std::ostream& stream) const {
+    stream << std::fixed << std::setprecision(3);
+    stream << "{\"traceEvents\":[\n";
+
+    auto first = true;
+    for (auto const& buffer : m_buffers) {
+        stream << (first ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+            << ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+        first = false;
+
+        for (auto const& event : buffer->events) {
+            stream << ",\n{\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << buffer->thread
+                << ",\"ts\":" << to_microseconds(event.start);
+
+            if (event.type == ProfileEventType::SCOPE) {
+                stream << ",\"ph\":\"X\",\"dur\":" << to_microseconds(event.duration) << "}";
+            } else {
+                stream << ",\"ph\":\"C\",\"args\":{\"value\":" << event.value << "}}";
+            }
+        }
+    }
+
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void Profiler::write_csv(std::ostream& stream) const {
+    stream << std::fixed << std::setprecision(3);
+    stream << "thread,type,name,start_us,duration_us,value\n";
+
+    for (auto const& buffer : m_buffers) {
+        for (auto const& event : buffer->events) {
+            auto const is_scope = event.type == ProfileEventType::SCOPE;
+            stream << buffer->thread << ','
+                << (is_scope ? "scope" : "counter") << ','
+                << event.name << ','
+                << to_microseconds(event.start) << ','
+                << (is_scope ? to_microseconds(event.duration) : 0.0) << ','
+                << event.value << '\n';
+        }
+    }
+}
+
+void Profiler::clear() {
+    std::lock_guard lock(m_mutex);
+
+    for (auto& buffer : m_buffers) {
+        buffer->events.clear();
+    }
+}
+
+// Buffers are never freed, so the pointer cached by a thread stays valid
+// for as long as the thread runs.
+Profiler::ThreadBuffer& Profiler::thread_buffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+
+    if (buffer == nullptr) {
+        std::lock_guard lock(m_mutex);
+
+        auto& new_buffer = m_buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        new_buffer->thread = m_buffers.size() - 1;
+        new_buffer->events.reserve(INITIAL_THREAD_EVENTS);
+        buffer = new_buffer.get();
+    }
+
+    return *buffer;
+}
+
+double to_microseconds(std::uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1000.0;
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vcam {
+
+enum class ProfileEventType {
+    SCOPE,
+    COUNTER
+};
+
+// Times are in nanoseconds since the profiler was created. Names aren't
+// copied, so they have to outlive the profiler, like string literals do.
+struct ProfileEvent {
+    ProfileEventType type;
+    char const* name;
+    std::uint64_t start;
+
+    // Scopes only.
+    std::uint64_t duration;
+
+    // Counters only.
+    double value;
+};
+
+// Timeline of named scopes and counter samples, for finding out where the
+// time of a frame goes. Every thread records into a buffer of its own, so
+// recording never waits for other threads, and nothing is recorded while
+// the profiler is disabled, which costs a relaxed load per scope.
+//
+// Recorded events can only be read, written out or cleared while no thread
+// is recording, e.g. between frames.
+class Profiler {
+public:
+    static Profiler& instance();
+
+    void enable(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool is_enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t now() const {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count());
+    }
+
+    void record_scope(char const* name, std::uint64_t start, std::uint64_t end);
+    void record_counter(char const* name, double value);
+
+    // Writes every event as Chrome's trace event format, which chrome://tracing
+    // and Perfetto can open, with one track per thread.
+    void write_chrome_trace(std::ostream& stream) const;
+
+    // Writes every event as a row of thread, type, name, start, duration and
+    // value, with times in microseconds.
+    void write_csv(std::ostream& stream) const;
+
+    void clear();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct ThreadBuffer {
+        std::size_t thread;
+        std::vector<ProfileEvent> events;
+    };
+
+    std::atomic<bool> m_enabled = false;
+    Clock::time_point m_epoch = Clock::now();
+
+    // Only taken when a thread records its first event.
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+    Profiler() = default;
+
+    ThreadBuffer& thread_buffer();
+};
+
+// Records the time between its construction and destruction as a scope,
+// if the profiler is enabled when it's constructed.
+class ProfileScope {
+public:
+    explicit ProfileScope(char const* name)
+        : m_name(name), m_is_recording(Profiler::instance().is_enabled()) {
+        if (m_is_recording) {
+            m_start = Profiler::instance().now();
+        }
+    }
+
+    ~ProfileScope() {
+        end();
+    }
+
+    // Ends the scope before its destruction, which then records nothing.
+    void end() {
+        if (m_is_recording) {
+            auto& profiler = Profiler::instance();
+            profiler.record_scope(m_name, m_start, profiler.now());
+            m_is_recording = false;
+        }
+    }
+
+    ProfileScope(ProfileScope const& other) = delete;
+    ProfileScope& operator=(ProfileScope const& other) = delete;
+
+private:
+    char const* m_name;
+    bool m_is_recording;
+    std::uint64_t m_start = 0;
+};
+
+}
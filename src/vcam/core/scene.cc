@@ -0,0 +1,48 @@
+#include <vcam/core/scene.hh>
+
+namespace vcam {
+
+Scene::Scene(std::size_t thread_count)
+    : m_transforms(&add_pool<TransformComponents>()), m_thread_pool(thread_count) { }
+
+Entity Scene::create_entity() {
+    if (!m_free_indices.empty()) {
+        auto const index = m_free_indices.back();
+        m_free_indices.pop_back();
+        return { index, m_generations[index] };
+    }
+
+    m_generations.push_back(0);
+    return { static_cast<std::uint32_t>(m_generations.size() - 1), 0 };
+}
+
+void Scene::destroy_entity(Entity entity) {
+    if (!is_alive(entity)) {
+        return;
+    }
+
+    for (auto& [type, pool] : m_pools) {
+        pool->remove(entity);
+    }
+
+    ++m_generations[entity.index];
+    m_free_indices.push_back(entity.index);
+}
+
+void Scene::on_update(float dt) {
+    m_transforms->save_previous();
+
+    for (auto& system : m_systems) {
+        system->on_update(*this, dt);
+    }
+}
+
+void Scene::on_render(float t) {
+    m_transforms->update_scene_transforms(t);
+
+    for (auto& system : m_systems) {
+        system->on_render(*this, t);
+    }
+}
+
+}
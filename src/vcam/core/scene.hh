@@ -1,24 +1,114 @@
 #pragma once
 
+#include <vcam/core/component_pool.hh>
 #include <vcam/core/entity.hh>
+#include <vcam/core/thread_pool.hh>
+#include <vcam/core/transform_components.hh>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace vcam {
 
+class Scene;
+
+// Systems advance the simulation in on_update, by steps of dt milliseconds,
+// and hand their state to the renderer in on_render, t of the way from
+// before the last step to after it. Each call handles every component of
+// the pools the system works on, rather than a single entity.
+class ISystem {
+public:
+    virtual ~ISystem() = default;
+    virtual void on_update(Scene& /*scene*/, float /*dt*/) { }
+    virtual void on_render(Scene& /*scene*/, float /*t*/) { }
+};
+
+// Entities, the pools of their components and the systems working on them.
+// Every scene has a TransformComponents pool, other pools have to be added
+// before they're used.
 class Scene {
 public:
-    void add_entity(std::shared_ptr<Entity> entity) {
-        m_entities.push_back(entity);
+    // Systems can split their work across thread_count threads, where zero
+    // uses every hardware thread and one keeps it on the calling thread.
+    explicit Scene(std::size_t thread_count = 1);
+
+    Scene(Scene const& other) = delete;
+    Scene& operator=(Scene const& other) = delete;
+
+    Entity create_entity();
+
+    // Removes the entity's components from every pool. Does nothing for
+    // entities which were already destroyed.
+    void destroy_entity(Entity entity);
+
+    bool is_alive(Entity entity) const {
+        return entity.index < m_generations.size() && m_generations[entity.index] == entity.generation;
+    }
+
+    std::size_t entity_count() const {
+        return m_generations.size() - m_free_indices.size();
+    }
+
+    template <typename Pool, typename... Args>
+    Pool& add_pool(Args&&... args) {
+        auto pool = std::make_unique<Pool>(std::forward<Args>(args)...);
+        auto& result = *pool;
+        m_pools[std::type_index(typeid(Pool))] = std::move(pool);
+        return result;
     }
 
-    std::vector<std::shared_ptr<Entity>> const& entities() const {
-        return m_entities;
+    template <typename Pool>
+    Pool& pool() {
+        return static_cast<Pool&>(*m_pools.at(std::type_index(typeid(Pool))));
+    }
+
+    TransformComponents& transforms() {
+        return *m_transforms;
+    }
+
+    // Systems run in the order they're added.
+    void add_system(std::unique_ptr<ISystem> system) {
+        m_systems.push_back(std::move(system));
+    }
+
+    void on_update(float dt);
+    void on_render(float t);
+
+    // Runs task(first, last) over consecutive ranges covering [0, count),
+    // spread across the scene's threads. Only a pointer to the task goes
+    // into the thread pool's std::function, which keeps it small enough not
+    // to allocate however much the task captures.
+    template <typename Task>
+    void parallel_for(std::size_t count, Task const& task) {
+        auto const range_count = (count + PARALLEL_RANGE_SIZE - 1) / PARALLEL_RANGE_SIZE;
+
+        m_thread_pool.parallel_for(range_count, [task = &task, count](std::size_t range) {
+            auto const first = range * PARALLEL_RANGE_SIZE;
+            (*task)(first, std::min(first + PARALLEL_RANGE_SIZE, count));
+            });
     }
 
 private:
-    std::vector<std::shared_ptr<Entity>> m_entities;
+    // Components handed to a thread at a time, enough to make up for taking
+    // them but few enough to balance the load across threads.
+    static constexpr std::size_t PARALLEL_RANGE_SIZE = 4096;
+
+    // Generation of every entity index, and the indices free for reuse.
+    std::vector<std::uint32_t> m_generations;
+    std::vector<std::uint32_t> m_free_indices;
+
+    std::unordered_map<std::type_index, std::unique_ptr<ComponentPool>> m_pools;
+    TransformComponents* m_transforms;
+
+    std::vector<std::unique_ptr<ISystem>> m_systems;
+
+    ThreadPool m_thread_pool;
 };
 
 }
@@ -0,0 +1,16 @@
+#pragma once
+
+// Instruction set detection shared by the SIMD kernels. Wider kernels are
+// compiled with per-function target attributes and picked at runtime, so the
+// rest of the build keeps targeting the baseline instruction set.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define VCAM_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(VCAM_X86) && (defined(__GNUC__) || defined(__clang__))
+#define VCAM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VCAM_TARGET_AVX2
+#endif
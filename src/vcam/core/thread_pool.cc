@@ -0,0 +1,92 @@
+#include <vcam/core/thread_pool.hh>
+
+#include <algorithm>
+
+namespace vcam {
+
+ThreadPool::ThreadPool(std::size_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    m_workers.reserve(thread_count - 1);
+    for (std::size_t i = 1; i < thread_count; ++i) {
+        m_workers.emplace_back([this] { run_worker(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_job_available.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, std::function<void(std::size_t)> const& task) {
+    if (count == 0) {
+        return;
+    }
+
+    if (m_workers.empty() || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_busy_workers = m_workers.size();
+        ++m_generation;
+    }
+    m_job_available.notify_all();
+
+    run_tasks();
+
+    std::unique_lock lock(m_mutex);
+    m_job_finished.wait(lock, [this] { return m_busy_workers == 0; });
+    m_task = nullptr;
+}
+
+void ThreadPool::run_worker() {
+    std::size_t generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_job_available.wait(lock, [&] { return m_stopping || m_generation != generation; });
+
+            if (m_stopping) {
+                return;
+            }
+
+            generation = m_generation;
+        }
+
+        run_tasks();
+
+        {
+            std::lock_guard lock(m_mutex);
+            --m_busy_workers;
+        }
+        m_job_finished.notify_one();
+    }
+}
+
+void ThreadPool::run_tasks() {
+    auto const& task = *m_task;
+
+    for (auto i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1)) {
+        task(i);
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vcam {
+
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t thread_count);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const& other) = delete;
+    ThreadPool& operator=(ThreadPool const& other) = delete;
+
+    std::size_t thread_count() const {
+        return m_workers.size() + 1;
+    }
+
+    // Runs task(0) ... task(count - 1) across the pool and the calling thread,
+    // returning once every index has been processed.
+    void parallel_for(std::size_t count, std::function<void(std::size_t)> const& task);
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_mutex;
+    std::condition_variable m_job_available;
+    std::condition_variable m_job_finished;
+
+    std::function<void(std::size_t)> const* m_task = nullptr;
+    std::size_t m_count = 0;
+    std::atomic<std::size_t> m_next = 0;
+    std::size_t m_generation = 0;
+    std::size_t m_busy_workers = 0;
+    bool m_stopping = false;
+
+    void run_worker();
+    void run_tasks();
+};
+
+}
@@ -0,0 +1,195 @@
+#include <vcam/core/transform_components.hh>
+
+namespace vcam {
+
+void TransformComponents::insert(Entity entity, glm::vec3 position, glm::vec3 rotation, glm::vec3 scale) {
+    auto const index = insert_entity(entity);
+
+    m_positions.push_back(position);
+    m_rotations.push_back(rotation);
+    m_scales.push_back(scale);
+
+    // Entities added between updates don't move until the next one.
+    m_previous_positions.push_back(position);
+    m_previous_rotations.push_back(rotation);
+    m_previous_scales.push_back(scale);
+
+    m_parents.push_back(NULL_ENTITY);
+    m_first_children.push_back(NULL_ENTITY);
+    m_next_siblings.push_back(NULL_ENTITY);
+
+    m_local_to_scene_transforms.push_back(glm::mat4(1.0f));
+    m_flags.push_back(0);
+    mark_stale(index);
+}
+
+void TransformComponents::remove(Entity entity) {
+    if (!contains(entity)) {
+        return;
+    }
+
+    auto const index = this->index(entity);
+    unlink_child(index);
+
+    auto child = m_first_children[index];
+    while (child != NULL_ENTITY) {
+        auto const child_index = this->index(child);
+        auto const next_sibling = m_next_siblings[child_index];
+
+        m_parents[child_index] = NULL_ENTITY;
+        m_next_siblings[child_index] = NULL_ENTITY;
+        mark_stale(child_index);
+
+        child = next_sibling;
+    }
+
+    remove_swapped(
+        remove_entity(entity),
+        m_positions,
+        m_rotations,
+        m_scales,
+        m_previous_positions,
+        m_previous_rotations,
+        m_previous_scales,
+        m_parents,
+        m_first_children,
+        m_next_siblings,
+        m_local_to_scene_transforms,
+        m_flags
+    );
+}
+
+void TransformComponents::parent(Entity entity, Entity parent) {
+    auto const index = this->index(entity);
+    unlink_child(index);
+
+    if (parent != NULL_ENTITY) {
+        auto const parent_index = this->index(parent);
+        m_parents[index] = parent;
+        m_next_siblings[index] = m_first_children[parent_index];
+        m_first_children[parent_index] = entity;
+    }
+
+    mark_stale(index);
+}
+
+// Entities which moved during the last update have been interpolated since,
+// so their cached transforms have to catch up with where they stopped.
+void TransformComponents::save_previous() {
+    for (auto const entity : m_moved_entities) {
+        if (!contains(entity)) {
+            continue;
+        }
+
+        auto const index = this->index(entity);
+        m_previous_positions[index] = m_positions[index];
+        m_previous_rotations[index] = m_rotations[index];
+        m_previous_scales[index] = m_scales[index];
+
+        m_flags[index] &= ~MOVED;
+        mark_stale(index);
+    }
+
+    m_moved_entities.clear();
+}
+
+// Updating an entity updates its descendants too, so entities which were
+// already updated along with an ancestor are skipped. Ones updated before
+// their ancestors are updated again, after them.
+void TransformComponents::update_scene_transforms(float t) {
+    for (auto const entity : m_changed_entities) {
+        if (contains(entity)) {
+            m_flags[index(entity)] &= ~CHANGED;
+        }
+    }
+    m_changed_entities.clear();
+
+    auto const update_descendants = [&](Entity root) {
+        m_descendants.push_back(root);
+
+        while (!m_descendants.empty()) {
+            auto const entity = m_descendants.back();
+            m_descendants.pop_back();
+
+            auto const index = this->index(entity);
+            update_scene_transform(index, t);
+
+            if ((m_flags[index] & CHANGED) == 0) {
+                m_flags[index] |= CHANGED;
+                m_changed_entities.push_back(entity);
+            }
+
+            for (auto child = m_first_children[index]; child != NULL_ENTITY; child = m_next_siblings[this->index(child)]) {
+                m_descendants.push_back(child);
+            }
+        }
+        };
+
+    for (auto const entity : m_moved_entities) {
+        if (contains(entity) && (m_flags[index(entity)] & CHANGED) == 0) {
+            update_descendants(entity);
+        }
+    }
+
+    for (auto const entity : m_stale_entities) {
+        if (!contains(entity)) {
+            continue;
+        }
+
+        auto const index = this->index(entity);
+        m_flags[index] &= ~STALE;
+        if ((m_flags[index] & CHANGED) == 0) {
+            update_descendants(entity);
+        }
+    }
+
+    m_stale_entities.clear();
+}
+
+void TransformComponents::mark_moved(std::size_t index) {
+    if ((m_flags[index] & MOVED) == 0) {
+        m_flags[index] |= MOVED;
+        m_moved_entities.push_back(entities()[index]);
+    }
+}
+
+void TransformComponents::mark_stale(std::size_t index) {
+    if ((m_flags[index] & STALE) == 0) {
+        m_flags[index] |= STALE;
+        m_stale_entities.push_back(entities()[index]);
+    }
+}
+
+void TransformComponents::unlink_child(std::size_t index) {
+    auto const parent = m_parents[index];
+    if (parent == NULL_ENTITY) {
+        return;
+    }
+
+    auto const entity = entities()[index];
+    auto const next_sibling = m_next_siblings[index];
+
+    auto* link = &m_first_children[this->index(parent)];
+    while (*link != entity) {
+        link = &m_next_siblings[this->index(*link)];
+    }
+    *link = next_sibling;
+
+    m_parents[index] = NULL_ENTITY;
+    m_next_siblings[index] = NULL_ENTITY;
+}
+
+void TransformComponents::update_scene_transform(std::size_t index, float t) {
+    auto const local_transform = calculate_transform_matrix(
+        interpolated_position(index, t),
+        interpolated_rotation(index, t),
+        interpolated_scale(index, t)
+    );
+
+    auto const parent = m_parents[index];
+    m_local_to_scene_transforms[index] = parent == NULL_ENTITY
+        ? local_transform
+        : m_local_to_scene_transforms[this->index(parent)] * local_transform;
+}
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <vcam/core/component_pool.hh>
+#include <vcam/core/math.hh>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vcam {
+
+// Position, Euler angle rotation and scale of entities relative to their
+// parents, or to the scene for entities without one, along with their
+// values before the last update, which frames interpolate from.
+//
+// Local to scene transforms are cached, and only recalculated for entities
+// which moved, or whose ancestors did. Entities which didn't move since the
+// update before the last one cost nothing per update or frame.
+class TransformComponents : public ComponentPool {
+public:
+    void insert(
+        Entity entity,
+        glm::vec3 position,
+        glm::vec3 rotation = glm::vec3(0.0f),
+        glm::vec3 scale = glm::vec3(1.0f)
+    );
+
+    // Children of the entity are left without a parent, keeping their local
+    // transforms.
+    virtual void remove(Entity entity) override;
+
+    glm::vec3 const& position(std::size_t index) const {
+        return m_positions[index];
+    }
+
+    void position(std::size_t index, glm::vec3 position) {
+        m_positions[index] = position;
+        mark_moved(index);
+    }
+
+    glm::vec3 const& rotation(std::size_t index) const {
+        return m_rotations[index];
+    }
+
+    void rotation(std::size_t index, glm::vec3 rotation) {
+        m_rotations[index] = rotation;
+        mark_moved(index);
+    }
+
+    glm::vec3 const& scale(std::size_t index) const {
+        return m_scales[index];
+    }
+
+    void scale(std::size_t index, glm::vec3 scale) {
+        m_scales[index] = scale;
+        mark_moved(index);
+    }
+
+    Entity parent(std::size_t index) const {
+        return m_parents[index];
+    }
+
+    // Attaches the entity to a parent, which has to have a transform and
+    // mustn't be one of its descendants, or detaches it for NULL_ENTITY.
+    void parent(Entity entity, Entity parent);
+
+    // Local state t of the way from before the last update to after it.
+    glm::vec3 interpolated_position(std::size_t index, float t) const {
+        return glm::mix(m_previous_positions[index], m_positions[index], t);
+    }
+
+    glm::vec3 interpolated_rotation(std::size_t index, float t) const {
+        return interpolate_angles(m_previous_rotations[index], m_rotations[index], t);
+    }
+
+    glm::vec3 interpolated_scale(std::size_t index, float t) const {
+        return glm::mix(m_previous_scales[index], m_scales[index], t);
+    }
+
+    // As of the last update_scene_transforms().
+    glm::mat4 const& local_to_scene_transform(std::size_t index) const {
+        return m_local_to_scene_transforms[index];
+    }
+
+    // Starts an update, which frames then interpolate from.
+    void save_previous();
+
+    // Recalculates the local to scene transforms of entities which moved,
+    // and of their descendants, t of the way from before the last update to
+    // after it.
+    void update_scene_transforms(float t);
+
+    // Entities whose local to scene transforms the last call to
+    // update_scene_transforms() recalculated.
+    std::span<Entity const> changed_entities() const {
+        return m_changed_entities;
+    }
+
+private:
+    enum Flags : std::uint8_t {
+        // Set from the first change during an update until the next one.
+        MOVED = 1 << 0,
+
+        // Set while in the stale list.
+        STALE = 1 << 1,
+
+        // Set while in the changed list.
+        CHANGED = 1 << 2
+    };
+
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_rotations;
+    std::vector<glm::vec3> m_scales;
+
+    // As of the start of the last update.
+    std::vector<glm::vec3> m_previous_positions;
+    std::vector<glm::vec3> m_previous_rotations;
+    std::vector<glm::vec3> m_previous_scales;
+
+    // Children are linked through their next siblings.
+    std::vector<Entity> m_parents;
+    std::vector<Entity> m_first_children;
+    std::vector<Entity> m_next_siblings;
+
+    std::vector<glm::mat4> m_local_to_scene_transforms;
+    std::vector<std::uint8_t> m_flags;
+
+    // Entities which moved during the current update, and ones whose cached
+    // transforms are out of date for any other reason, such as having been
+    // interpolated before they stopped moving. Either may hold entities
+    // which have since been removed.
+    std::vector<Entity> m_moved_entities;
+    std::vector<Entity> m_stale_entities;
+
+    std::vector<Entity> m_changed_entities;
+    std::vector<Entity> m_descendants;
+
+    void mark_moved(std::size_t index);
+    void mark_stale(std::size_t index);
+
+    void unlink_child(std::size_t index);
+    void update_scene_transform(std::size_t index, float t);
+};
+
+}
@@ -0,0 +1,54 @@
+#include <vcam/core/worker_thread.hh>
+
+#include <utility>
+
+namespace vcam {
+
+WorkerThread::WorkerThread() : m_thread([this] { run(); }) { }
+
+WorkerThread::~WorkerThread() {
+    {
+        std::unique_lock lock(m_mutex);
+        m_job_finished.wait(lock, [this] { return !m_busy; });
+        m_stopping = true;
+    }
+    m_job_available.notify_one();
+
+    m_thread.join();
+}
+
+void WorkerThread::submit(std::function<void()> job) {
+    {
+        std::unique_lock lock(m_mutex);
+        m_job_finished.wait(lock, [this] { return !m_busy; });
+        m_job = std::move(job);
+        m_busy = true;
+    }
+    m_job_available.notify_one();
+}
+
+void WorkerThread::wait() {
+    std::unique_lock lock(m_mutex);
+    m_job_finished.wait(lock, [this] { return !m_busy; });
+}
+
+void WorkerThread::run() {
+    std::unique_lock lock(m_mutex);
+
+    while (true) {
+        m_job_available.wait(lock, [this] { return m_stopping || m_busy; });
+
+        if (m_stopping) {
+            return;
+        }
+
+        lock.unlock();
+        m_job();
+        lock.lock();
+
+        m_busy = false;
+        m_job_finished.notify_all();
+    }
+}
+
+}
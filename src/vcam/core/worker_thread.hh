@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace vcam {
+
+// Runs one job at a time in the background, so the submitting thread can
+// carry on until it needs the job's result.
+class WorkerThread {
+public:
+    WorkerThread();
+    ~WorkerThread();
+
+    WorkerThread(WorkerThread const& other) = delete;
+    WorkerThread& operator=(WorkerThread const& other) = delete;
+
+    // Waits for the previous job to finish, then starts this one and returns.
+    void submit(std::function<void()> job);
+
+    // Returns once the last submitted job has finished.
+    void wait();
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_job_available;
+    std::condition_variable m_job_finished;
+
+    std::function<void()> m_job;
+    bool m_busy = false;
+    bool m_stopping = false;
+
+    // Started last, once everything it uses is constructed.
+    std::thread m_thread;
+
+    void run();
+};
+
+}
@@ -1,31 +1,82 @@
-#include <vcam/core/entity.hh>
+#include <vcam/core/frame_scheduler.hh>
 #include <vcam/core/math.hh>
+#include <vcam/core/profiler.hh>
+#include <vcam/core/scene.hh>
 #include <vcam/movement/movement_controller.hh>
 #include <vcam/render/model.hh>
 #include <vcam/render/camera_component.hh>
 #include <vcam/render/light_component.hh>
+#include <vcam/render/materials.hh>
+#include <vcam/render/mesh_generation.hh>
+#include <vcam/render/mesh_loader.hh>
 #include <vcam/render/render_component.hh>
 #include <vcam/render/render_system.hh>
-#include <vcam/core/scene.hh>
+#include <vcam/render/texture_import.hh>
+#include <vcam/render/window_render_target.hh>
 
 #include <glm/glm.hpp>
 #include <SDL3/SDL.h>
 #include <SDL3/SDL_main.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
 #include <memory>
 #include <random>
 #include <string>
+#include <vector>
 
 struct GlobalState {
     bool is_running;
     vcam::RenderSystem render_system;
     vcam::Scene scene;
+
+    // Owned by the render system.
+    vcam::WindowRenderTarget* window_target;
+    bool show_overlay;
+
+    // Loads the --mesh file in the background, adding it to the scene once
+    // it's loaded.
+    std::unique_ptr<vcam::MeshLoader> mesh_loader;
+    std::future<vcam::LoadedLevelsOfDetail> loading_mesh;
+
+    // The --texture file, mapped onto the mesh if it has texture
+    // coordinates.
+    std::shared_ptr<vcam::Texture const> mesh_texture;
 };
 
+// Simulation steps per second, independent of the frame rate.
+constexpr std::uint64_t STEPS_PER_SECOND = 120;
+
+// Frame rate cap unless --fps overrides it, zero for uncapped.
+constexpr double DEFAULT_FRAME_RATE = 60.0;
+
+// Milliseconds per frame rasterization may take before the render
+// resolution drops below the window's.
+constexpr double RASTER_BUDGET = 10.0;
+
+// Files a captured trace is written to, in the working directory.
+constexpr char const* TRACE_JSON_PATH = "vcam_trace.json";
+constexpr char const* TRACE_CSV_PATH = "vcam_trace.csv";
+
 void on_init(GlobalState& state);
 void on_update(GlobalState& state, float dt);
+void on_render(GlobalState& state, float t);
 void on_shutdown(GlobalState& state);
+void on_key_down(GlobalState& state, SDL_KeyboardEvent const& event);
+void add_loaded_mesh(GlobalState& state, vcam::LoadedLevelsOfDetail levels_of_detail);
+
+double parse_frame_rate(int argc, char* argv[]);
+char const* parse_path(int argc, char* argv[], char const* option);
+void show_frame_times(SDL_Window* window, vcam::FrameTimeHistory const& history);
+void toggle_trace(GlobalState& state);
+void cycle_multisampling(GlobalState& state);
+std::vector<std::string> describe_last_frame(vcam::RenderSystem const& render_system);
 
 int main(int argc, char* argv[]) {
     if (!SDL_Init(SDL_INIT_VIDEO)) {
@@ -65,49 +116,72 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    GlobalState state{
-        .is_running = true,
-        .render_system = vcam::RenderSystem(renderer),
-    };
+    // The state owns the window's render target, whose texture has to be
+    // destroyed before the renderer.
+    {
+        auto window_target = std::make_unique<vcam::WindowRenderTarget>(renderer);
+        auto* const window_target_pointer = window_target.get();
+
+        GlobalState state{
+            .is_running = true,
+            .render_system = vcam::RenderSystem(std::move(window_target)),
+            .scene = vcam::Scene(),
+            .window_target = window_target_pointer,
+            .show_overlay = false,
+            .mesh_loader = std::make_unique<vcam::MeshLoader>(),
+        };
+
+        if (auto const* const mesh_path = parse_path(argc, argv, "--mesh")) {
+            state.loading_mesh = state.mesh_loader->load(mesh_path);
+        }
 
-    on_init(state);
+        if (auto const* const texture_path = parse_path(argc, argv, "--texture")) {
+            if (auto texture = vcam::import_bmp(texture_path)) {
+                state.mesh_texture = std::make_shared<vcam::Texture const>(std::move(*texture));
+            }
+        }
 
-    constexpr std::uint32_t MILLISECONDS_PER_SECOND = 1000;
-    constexpr std::uint32_t FRAMES_PER_SECOND = 60;
+        on_init(state);
 
-    auto const target = MILLISECONDS_PER_SECOND / FRAMES_PER_SECOND;
-    auto last_ticks = SDL_GetTicks();
+        vcam::FrameScheduler scheduler(SDL_NS_PER_SECOND / STEPS_PER_SECOND, parse_frame_rate(argc, argv));
+        auto const step_milliseconds = static_cast<float>(scheduler.step_time()) / SDL_NS_PER_MS;
+        auto last_title_update = SDL_GetTicksNS();
 
-    while (state.is_running) {
-        auto current_ticks = SDL_GetTicks();
+        while (state.is_running) {
+            auto const steps = scheduler.begin_frame();
 
-        auto const dt = current_ticks - last_ticks;
+            SDL_Event event;
+            while (SDL_PollEvent(&event)) {
+                switch (event.type) {
+                case SDL_EVENT_QUIT:
+                    state.is_running = false;
+                    break;
 
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-            case SDL_EVENT_QUIT:
-                state.is_running = false;
-                break;
+                case SDL_EVENT_KEY_DOWN:
+                    on_key_down(state, event.key);
+                    break;
 
-            default:
-                break;
+                default:
+                    break;
+                }
             }
-        }
 
-        on_update(state, dt);
+            for (std::uint32_t i = 0; i < steps; ++i) {
+                on_update(state, step_milliseconds);
+            }
 
-        last_ticks = current_ticks;
+            on_render(state, scheduler.interpolation());
 
-        current_ticks = SDL_GetTicks();
-        auto const elapsed = current_ticks - last_ticks;
+            if (SDL_GetTicksNS() - last_title_update >= SDL_NS_PER_SECOND) {
+                show_frame_times(window, scheduler.history());
+                last_title_update = SDL_GetTicksNS();
+            }
 
-        if (elapsed < target) {
-            SDL_Delay(target - elapsed);
+            scheduler.end_frame();
         }
-    }
 
-    on_shutdown(state);
+        on_shutdown(state);
+    }
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -116,196 +190,276 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
-static vcam::Mesh generate_sphere_mesh(std::size_t subdivisions);
-static vcam::Material create_gold_material();
-static vcam::Material create_plastic_material();
-
 void on_init(GlobalState& state) {
-    auto const mesh = generate_sphere_mesh(3);
+    state.render_system.raster_budget(RASTER_BUDGET);
+
+    auto& scene = state.scene;
+    auto& transforms = scene.transforms();
+    auto& movements = scene.add_pool<vcam::MovementComponents>();
+    auto& renders = scene.add_pool<vcam::RenderComponents>(state.render_system);
+    auto& lights = scene.add_pool<vcam::LightComponents>(state.render_system);
+    auto& cameras = scene.add_pool<vcam::CameraComponents>(state.render_system);
+
+    scene.add_system(std::make_unique<vcam::MovementController>());
+    scene.add_system(std::make_unique<vcam::LightComponentSystem>());
+    scene.add_system(std::make_unique<vcam::CameraComponentSystem>());
+    scene.add_system(std::make_unique<vcam::RenderComponentSystem>());
+
+    auto const levels_of_detail = vcam::generate_sphere_levels_of_detail(3);
     auto model = std::make_shared<vcam::Model>(
-        mesh,
-        create_gold_material()
+        levels_of_detail,
+        vcam::create_gold_material()
     );
 
-    auto entity = std::make_shared<vcam::Entity>();
-    entity->position(glm::vec3(-2.0f, 0.0f, 0.0f));
-    entity->add_component(
-        std::make_unique<vcam::RenderComponent>(state.render_system, model)
-    );
-    state.scene.add_entity(entity);
+    auto entity = scene.create_entity();
+    transforms.insert(entity, glm::vec3(-2.0f, 0.0f, 0.0f));
+    renders.insert(entity, model);
 
     model = std::make_shared<vcam::Model>(
-        mesh,
-        create_plastic_material()
+        levels_of_detail,
+        vcam::create_plastic_material()
     );
-    entity = std::make_shared<vcam::Entity>();
-    entity->position(glm::vec3(2.0f, 0.0f, 0.0f));
-    entity->add_component(
-        std::make_unique<vcam::RenderComponent>(state.render_system, model)
+    entity = scene.create_entity();
+    transforms.insert(entity, glm::vec3(2.0f, 0.0f, 0.0f));
+    renders.insert(entity, model);
+
+    auto const light_entity = scene.create_entity();
+    transforms.insert(light_entity, glm::vec3(0.0f));
+    lights.insert(
+        light_entity,
+        glm::vec3(0.2f),
+        glm::vec3(1.0f),
+        glm::vec3(0.8f)
     );
-    state.scene.add_entity(entity);
-
-    auto light_entity = std::make_shared<vcam::Entity>();
-    light_entity->add_component(
-        std::make_unique<vcam::LightComponent>(
-            state.render_system,
-            glm::vec3(0.2f),
-            glm::vec3(1.0f),
-            glm::vec3(0.8f)
-        ));
-    state.scene.add_entity(light_entity);
-
-    auto camera_entity = std::make_shared<vcam::Entity>();
-    camera_entity->position(glm::vec3(0.0f, 0.0f, -10.0f));
-    camera_entity->add_component(std::make_unique<vcam::MovementController>());
-    camera_entity->add_component(std::make_unique<vcam::CameraComponent>(state.render_system));
-    state.scene.add_entity(camera_entity);
 
+    auto const camera_entity = scene.create_entity();
+    transforms.insert(camera_entity, glm::vec3(0.0f, 0.0f, -10.0f));
+    movements.insert(camera_entity);
+    cameras.insert(camera_entity);
+
+    // Settles every entity's state before the first frame interpolates it.
     on_update(state, 0.0f);
 }
 
 void on_update(GlobalState& state, float dt) {
-    for (auto entity : state.scene.entities()) {
-        entity->on_update(dt);
+    auto& loading_mesh = state.loading_mesh;
+    if (loading_mesh.valid() && loading_mesh.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        add_loaded_mesh(state, loading_mesh.get());
     }
 
-    state.render_system.render();
+    state.scene.on_update(dt);
 }
 
-void on_shutdown(GlobalState& state) { }
+// Frames are rendered while the next one is updated, and presented when
+// the one after it is submitted, so what's on screen lags one frame behind.
+void on_render(GlobalState& state, float t) {
+    state.scene.on_render(t);
 
-static vcam::Mesh generate_icosahedron_mesh();
+    if (state.show_overlay) {
+        state.window_target->overlay(describe_last_frame(state.render_system));
+    }
 
-vcam::Mesh generate_sphere_mesh(std::size_t subdivisions) {
-    auto const mesh = generate_icosahedron_mesh();
+    state.render_system.submit_frame();
+}
 
-    std::vector<glm::vec3> vertices(mesh.vertices());
-    std::vector<std::array<std::size_t, 3>> triangles(mesh.triangles());
-    std::vector<std::array<glm::vec3, 3>> triangle_normals(mesh.triangle_normals());
+void on_shutdown(GlobalState& state) {
+    if (vcam::Profiler::instance().is_enabled()) {
+        toggle_trace(state);
+    }
 
-    for (auto i = 0; i < subdivisions; ++i) {
-        auto next_vertices = vertices;
-        std::vector<std::array<std::size_t, 3>> next_triangles;
-        std::vector<std::array<glm::vec3, 3>> next_triangle_normals;
+    state.render_system.finish_frame();
+}
 
-        for (auto& triangle : triangles) {
-            auto const& v0 = vertices[triangle[0]];
-            auto const& v1 = vertices[triangle[1]];
-            auto const& v2 = vertices[triangle[2]];
+// F3 shows the stage timings and counters of the last frame, F4 starts and
+// stops capturing a trace, F5 cycles through 1, 4 and 8 samples per pixel.
+void on_key_down(GlobalState& state, SDL_KeyboardEvent const& event) {
+    if (event.repeat) {
+        return;
+    }
 
-            auto const mid01 = glm::normalize((v0 + v1) * 0.5f);
-            auto const mid12 = glm::normalize((v1 + v2) * 0.5f);
-            auto const mid20 = glm::normalize((v2 + v0) * 0.5f);
+    switch (event.scancode) {
+    case SDL_SCANCODE_F3:
+        state.show_overlay = !state.show_overlay;
+        if (!state.show_overlay) {
+            state.window_target->overlay({});
+        }
+        break;
 
-            next_vertices.push_back(mid01);
-            next_vertices.push_back(mid12);
-            next_vertices.push_back(mid20);
+    case SDL_SCANCODE_F4:
+        toggle_trace(state);
+        break;
 
-            auto const index01 = next_vertices.size() - 3;
-            auto const index12 = next_vertices.size() - 2;
-            auto const index20 = next_vertices.size() - 1;
+    case SDL_SCANCODE_F5:
+        cycle_multisampling(state);
+        break;
 
-            next_triangles.push_back({ triangle[0], index01, index20 });
-            next_triangles.push_back({ triangle[1], index12, index01 });
-            next_triangles.push_back({ triangle[2], index20, index12 });
-            next_triangles.push_back({ index01, index12, index20 });
+    default:
+        break;
+    }
+}
 
-            auto const normal01 = glm::normalize(mid01);
-            auto const normal12 = glm::normalize(mid12);
-            auto const normal20 = glm::normalize(mid20);
-            next_triangle_normals.push_back({ v0, normal01, normal20 });
-            next_triangle_normals.push_back({ v1, normal12, normal01 });
-            next_triangle_normals.push_back({ v2, normal20, normal12 });
-            next_triangle_normals.push_back({ normal01, normal12, normal20 });
+// Meshes are scaled and moved to fit behind the spheres, whatever the units
+// and origin they were modeled in.
+void add_loaded_mesh(GlobalState& state, vcam::LoadedLevelsOfDetail levels_of_detail) {
+    if (!levels_of_detail) {
+        return;
+    }
+
+    auto const bounding_sphere = levels_of_detail->front().mesh.bounding_sphere();
+    auto const scale = bounding_sphere.radius > 0.0f ? 2.0f / bounding_sphere.radius : 1.0f;
+    SDL_Log("Loaded %zu triangles", levels_of_detail->front().mesh.triangles().size());
+
+    auto const model = std::make_shared<vcam::Model>(
+        std::move(*levels_of_detail),
+        state.mesh_texture != nullptr ? vcam::create_textured_material(state.mesh_texture) : vcam::create_plastic_material()
+    );
+
+    auto& scene = state.scene;
+    auto const entity = scene.create_entity();
+    scene.transforms().insert(
+        entity,
+        glm::vec3(0.0f, 0.0f, 4.0f) - bounding_sphere.center * scale,
+        glm::vec3(0.0f),
+        glm::vec3(scale)
+    );
+    scene.pool<vcam::RenderComponents>().insert(entity, model);
+}
+
+double parse_frame_rate(int argc, char* argv[]) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--fps") == 0) {
+            return std::max(std::strtod(argv[i + 1], nullptr), 0.0);
         }
+    }
+
+    return DEFAULT_FRAME_RATE;
+}
+
+char const* parse_path(int argc, char* argv[], char const* option) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], option) == 0) {
+            return argv[i + 1];
+        }
+    }
+
+    return nullptr;
+}
 
-        vertices = next_vertices;
-        triangles = next_triangles;
-        triangle_normals = next_triangle_normals;
+// Shows the frame rate and frame times over the frame time history in the
+// window's title.
+void show_frame_times(SDL_Window* window, vcam::FrameTimeHistory const& history) {
+    if (history.size() == 0) {
+        return;
     }
 
-    return vcam::Mesh(
-        vertices,
-        triangles,
-        triangle_normals
+    std::uint64_t total_time = 0;
+    std::uint64_t total_work_time = 0;
+    std::uint64_t longest_time = 0;
+    for (std::size_t i = 0; i < history.size(); ++i) {
+        total_time += history[i].frame_time;
+        total_work_time += history[i].work_time;
+        longest_time = std::max(longest_time, history[i].frame_time);
+    }
+
+    auto const average_milliseconds = [&](std::uint64_t total) {
+        return static_cast<double>(total) / SDL_NS_PER_MS / history.size();
+        };
+
+    char title[128];
+    std::snprintf(
+        title,
+        sizeof(title),
+        "VirtualCamera - %.1f fps, %.2f ms average, %.2f ms worst, %.2f ms busy",
+        SDL_NS_PER_SECOND * static_cast<double>(history.size()) / total_time,
+        average_milliseconds(total_time),
+        static_cast<double>(longest_time) / SDL_NS_PER_MS,
+        average_milliseconds(total_work_time)
     );
+    SDL_SetWindowTitle(window, title);
 }
 
-vcam::Mesh generate_icosahedron_mesh() {
-    float phi = (1.0f + sqrt(5.0f)) * 0.5f;
-    float a = 1.0f;
-    float b = 1.0f / phi;
-
-    std::vector<glm::vec3> vertices;
-    std::vector<std::array<std::size_t, 3>> triangles;
-    std::vector<std::array<glm::vec3, 3>> normals;
-
-    vertices.emplace_back(0, b, -a);
-    vertices.emplace_back(b, a, 0);
-    vertices.emplace_back(-b, a, 0);
-    vertices.emplace_back(0, b, a);
-    vertices.emplace_back(0, -b, a);
-    vertices.emplace_back(-a, 0, b);
-    vertices.emplace_back(0, -b, -a);
-    vertices.emplace_back(a, 0, -b);
-    vertices.emplace_back(a, 0, b);
-    vertices.emplace_back(-a, 0, -b);
-    vertices.emplace_back(b, -a, 0);
-    vertices.emplace_back(-b, -a, 0);
-
-    for (auto& vertex : vertices) {
-        auto const normal = glm::normalize(vertex);
-        vertex = normal;
+// Stopping waits for the frame in flight, so that no thread is recording
+// while the trace is written.
+void toggle_trace(GlobalState& state) {
+    auto& profiler = vcam::Profiler::instance();
+
+    if (!profiler.is_enabled()) {
+        profiler.clear();
+        profiler.enable(true);
+        SDL_Log("Capturing a trace");
+        return;
     }
 
-    triangles.push_back({ 0, 1, 2 });
-    triangles.push_back({ 3, 2, 1 });
-    triangles.push_back({ 3, 4, 5 });
-    triangles.push_back({ 3, 8, 4 });
-    triangles.push_back({ 0, 6, 7 });
-    triangles.push_back({ 0, 9, 6 });
-    triangles.push_back({ 4, 10, 11 });
-    triangles.push_back({ 6, 11, 10 });
-    triangles.push_back({ 2, 5, 9 });
-    triangles.push_back({ 11, 9, 5 });
-    triangles.push_back({ 1, 7, 8 });
-    triangles.push_back({ 10, 8, 7 });
-    triangles.push_back({ 3, 5, 2 });
-    triangles.push_back({ 3, 1, 8 });
-    triangles.push_back({ 0, 2, 9 });
-    triangles.push_back({ 0, 7, 1 });
-    triangles.push_back({ 6, 9, 11 });
-    triangles.push_back({ 6, 10, 7 });
-    triangles.push_back({ 4, 11, 5 });
-    triangles.push_back({ 4, 8, 10 });
-
-    for (auto const& triangle : triangles) {
-        normals.push_back({
-                vertices[triangle[0]],
-                vertices[triangle[1]],
-                vertices[triangle[2]],
-            });
+    profiler.enable(false);
+    state.render_system.finish_frame();
+
+    std::ofstream json(TRACE_JSON_PATH);
+    profiler.write_chrome_trace(json);
+
+    std::ofstream csv(TRACE_CSV_PATH);
+    profiler.write_csv(csv);
+
+    profiler.clear();
+
+    if (!json || !csv) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write the trace");
+        return;
     }
 
-    return vcam::Mesh(vertices, triangles, normals);
+    SDL_Log("Wrote the trace to %s and %s", TRACE_JSON_PATH, TRACE_CSV_PATH);
 }
 
-vcam::Material create_gold_material() {
-    return vcam::Material(
-        glm::vec3(1.0f, 0.843f, 0.0f),
-        100.0f,
-        glm::vec3(0.628f, 0.555f, 0.366f),
-        glm::vec3(0.75164f, 0.60648f, 0.22648f),
-        glm::vec3(0.24725f, 0.1995f, 0.0745f)
-    );
+void cycle_multisampling(GlobalState& state) {
+    auto& render_system = state.render_system;
+
+    switch (render_system.multisampling()) {
+    case vcam::Multisampling::OFF:
+        render_system.multisampling(vcam::Multisampling::X4);
+        SDL_Log("Multisampling with 4 samples");
+        break;
+
+    case vcam::Multisampling::X4:
+        render_system.multisampling(vcam::Multisampling::X8);
+        SDL_Log("Multisampling with 8 samples");
+        break;
+
+    case vcam::Multisampling::X8:
+        render_system.multisampling(vcam::Multisampling::OFF);
+        SDL_Log("Multisampling off");
+        break;
+    }
 }
 
-vcam::Material create_plastic_material() {
-    return vcam::Material(
-        glm::vec3(0.8f, 0.1f, 0.1f),
-        10.0f,
-        glm::vec3(0.5f, 0.5f, 0.5f),
-        glm::vec3(0.8f, 0.1f, 0.1f),
-        glm::vec3(0.1f, 0.01f, 0.01f)
-    );
+template <typename... Args>
+std::string format_line(char const* format, Args... args) {
+    char line[128];
+    std::snprintf(line, sizeof(line), format, args...);
+    return line;
+}
+
+std::vector<std::string> describe_last_frame(vcam::RenderSystem const& render_system) {
+    auto const& timings = render_system.last_frame_timings();
+    auto const& statistics = render_system.last_frame_statistics();
+
+    return {
+        format_line("frame     %6.2f ms", timings.total),
+        format_line("begin     %6.2f ms", timings.begin),
+        format_line("culling   %6.2f ms", timings.culling),
+        format_line("geometry  %6.2f ms", timings.geometry),
+        format_line("clip      %6.2f ms", timings.clip),
+        format_line("binning   %6.2f ms", timings.binning),
+        format_line("raster    %6.2f ms", timings.raster),
+        format_line("upscale   %6.2f ms", timings.upscale),
+        format_line("present   %6.2f ms", timings.present),
+        "",
+        format_line("triangles %zu submitted", statistics.submitted_triangles),
+        format_line("          %zu rejected, %zu accepted, %zu clipped",
+            statistics.rejected_triangles, statistics.accepted_triangles, statistics.clipped_triangles),
+        format_line("          %zu back faces, %zu culled", statistics.back_faces, statistics.culled_triangles),
+        format_line("fragments %zu tested, %zu depth failed", statistics.tested_fragments, statistics.depth_failed_fragments),
+        format_line("          %zu shaded, %.2f overdraw", statistics.shaded_fragments, statistics.overdraw),
+        format_line("          %zu expanded pixels, %zu compressed tiles", statistics.expanded_pixels, statistics.compressed_tiles),
+        format_line("scale     %.0f%%", statistics.resolution_scale * 100.0),
+        vcam::Profiler::instance().is_enabled() ? "tracing (F4 stops)" : "",
+    };
 }
@@ -0,0 +1,41 @@
+#include <vcam/render/mesh_file.hh>
+#include <vcam/render/mesh_loader.hh>
+
+#include <SDL3/SDL_log.h>
+
+#include <chrono>
+#include <cstdio>
+
+// Converts OBJ and PLY files into mesh files, generating their levels of
+// detail once here rather than every time they're loaded.
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::printf("usage: vcam_convert INPUT.obj|INPUT.ply OUTPUT%s\n", vcam::MESH_FILE_EXTENSION);
+        return 1;
+    }
+
+    auto const start = std::chrono::steady_clock::now();
+
+    auto const levels_of_detail = vcam::load_levels_of_detail(argv[1]);
+    if (!levels_of_detail) {
+        return 1;
+    }
+
+    if (!vcam::write_mesh_file(argv[2], *levels_of_detail)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to write %s", argv[2]);
+        return 1;
+    }
+
+    auto const end = std::chrono::steady_clock::now();
+
+    std::printf(
+        "%zu levels of detail, %zu to %zu triangles, converted in %.1f ms\n",
+        levels_of_detail->size(),
+        levels_of_detail->front().mesh.triangles().size(),
+        levels_of_detail->back().mesh.triangles().size(),
+        std::chrono::duration<double, std::milli>(end - start).count()
+    );
+
+    return 0;
+}
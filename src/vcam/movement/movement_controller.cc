@@ -5,98 +5,135 @@
 
 namespace vcam {
 
-static glm::vec3 calculate_rotation_delta(bool const* keyboard, float dt);
-static glm::vec3 calculate_translation_delta(bool const* keyboard, float dt);
-
-void MovementController::on_update(Entity& entity, float dt) {
-    auto* keyboard = SDL_GetKeyboardState(nullptr);
-
-    auto const dr = calculate_rotation_delta(keyboard, dt);
-    auto const dtr = calculate_translation_delta(keyboard, dt);
+// Axes the keyboard moves along, scaled by the speed multiplier held.
+static glm::vec3 calculate_rotation_direction(bool const* keyboard);
+static glm::vec3 calculate_translation_direction(bool const* keyboard);
+
+void MovementComponents::insert(Entity entity, float translation_speed, float rotation_speed) {
+    insert_entity(entity);
+    translation_speeds.push_back(translation_speed);
+    rotation_speeds.push_back(rotation_speed);
+}
 
-    auto rotation = entity.rotation();
-    auto position = entity.position();
+void MovementComponents::remove(Entity entity) {
+    if (!contains(entity)) {
+        return;
+    }
 
-    auto const local_delta_transform = calculate_transform_matrix(dtr, dr, glm::vec3(1.0f));
-    auto const local_to_scene_transform = calculate_transform_matrix(position, rotation, glm::vec3(1.0f));
-    auto const new_local_to_scene_transform = local_to_scene_transform * local_delta_transform;
+    remove_swapped(remove_entity(entity), translation_speeds, rotation_speeds);
+}
 
-    auto const new_position = glm::vec3(new_local_to_scene_transform * glm::vec4(glm::vec3(0.0f), 1.0f));
+void MovementController::on_update(Scene& scene, float dt) {
+    auto* keyboard = SDL_GetKeyboardState(nullptr);
 
-    glm::vec3 new_rotation;
-    glm::extractEulerAngleYXZ(
-        new_local_to_scene_transform,
-        new_rotation.y,
-        new_rotation.x,
-        new_rotation.z
-    );
+    auto const dr = calculate_rotation_direction(keyboard) * dt;
+    auto const dtr = calculate_translation_direction(keyboard) * dt;
+    if (dr == glm::vec3(0.0f) && dtr == glm::vec3(0.0f)) {
+        return;
+    }
 
-    entity.position(new_position);
-    entity.rotation(new_rotation);
+    auto& movements = scene.pool<MovementComponents>();
+    auto& transforms = scene.transforms();
+    auto const entities = movements.entities();
+
+    // New transforms are calculated in parallel, but only set afterwards,
+    // as setting them records which entities moved.
+    m_positions.resize(movements.size());
+    m_rotations.resize(movements.size());
+    scene.parallel_for(movements.size(), [&](std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i) {
+            auto const transform = transforms.index(entities[i]);
+
+            auto const local_delta_transform = calculate_transform_matrix(
+                dtr * movements.translation_speeds[i],
+                dr * movements.rotation_speeds[i],
+                glm::vec3(1.0f)
+            );
+            auto const local_to_parent_transform = calculate_transform_matrix(
+                transforms.position(transform),
+                transforms.rotation(transform),
+                glm::vec3(1.0f)
+            );
+            auto const new_local_to_parent_transform = local_to_parent_transform * local_delta_transform;
+
+            m_positions[i] = glm::vec3(new_local_to_parent_transform * glm::vec4(glm::vec3(0.0f), 1.0f));
+
+            glm::extractEulerAngleYXZ(
+                new_local_to_parent_transform,
+                m_rotations[i].y,
+                m_rotations[i].x,
+                m_rotations[i].z
+            );
+        }
+        });
+
+    for (std::size_t i = 0; i < movements.size(); ++i) {
+        auto const transform = transforms.index(entities[i]);
+        transforms.position(transform, m_positions[i]);
+        transforms.rotation(transform, m_rotations[i]);
+    }
 }
 
-glm::vec3 calculate_rotation_delta(bool const* keyboard, float dt) {
-    auto speed = 0.0005f;
-
+glm::vec3 calculate_rotation_direction(bool const* keyboard) {
     glm::vec3 rotation(0.0f);
 
     if (keyboard[SDL_SCANCODE_UP]) {
-        rotation.x -= speed * dt;
+        rotation.x -= 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_DOWN]) {
-        rotation.x += speed * dt;
+        rotation.x += 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_LEFT]) {
-        rotation.y -= speed * dt;
+        rotation.y -= 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_RIGHT]) {
-        rotation.y += speed * dt;
+        rotation.y += 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_Q]) {
-        rotation.z += speed * dt;
+        rotation.z += 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_E]) {
-        rotation.z -= speed * dt;
+        rotation.z -= 1.0f;
     }
 
     return rotation;
 }
 
-glm::vec3 calculate_translation_delta(bool const* keyboard, float dt) {
-    auto speed = 0.0025f;
-    if (keyboard[SDL_SCANCODE_LSHIFT]) {
-        speed *= 2.0f;
-    }
-
+glm::vec3 calculate_translation_direction(bool const* keyboard) {
     glm::vec3 translation(0.0f);
 
     if (keyboard[SDL_SCANCODE_W]) {
-        translation.z += speed * dt;
+        translation.z += 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_S]) {
-        translation.z -= speed * dt;
+        translation.z -= 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_A]) {
-        translation.x -= speed * dt;
+        translation.x -= 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_D]) {
-        translation.x += speed * dt;
+        translation.x += 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_LCTRL]) {
-        translation.y -= speed * dt;
+        translation.y -= 1.0f;
     }
 
     if (keyboard[SDL_SCANCODE_SPACE]) {
-        translation.y += speed * dt;
+        translation.y += 1.0f;
+    }
+
+    // Shift doubles the speed.
+    if (keyboard[SDL_SCANCODE_LSHIFT]) {
+        translation *= 2.0f;
     }
 
     return translation;
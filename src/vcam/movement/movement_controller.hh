@@ -1,12 +1,35 @@
 #pragma once
 
-#include <vcam/core/entity.hh>
+#include <vcam/core/component_pool.hh>
+#include <vcam/core/scene.hh>
+
+#include <glm/glm.hpp>
+
+#include <vector>
 
 namespace vcam {
 
-class MovementController : public IComponent {
+// Speeds at which the keyboard moves entities, in units and radians per
+// millisecond.
+class MovementComponents : public ComponentPool {
+public:
+    std::vector<float> translation_speeds;
+    std::vector<float> rotation_speeds;
+
+    void insert(Entity entity, float translation_speed = 0.0025f, float rotation_speed = 0.0005f);
+
+    virtual void remove(Entity entity) override;
+};
+
+// Flies entities with movement components around, relative to their own
+// orientation.
+class MovementController : public ISystem {
 public:
-    virtual void on_update(Entity& entity, float dt) override;
+    virtual void on_update(Scene& scene, float dt) override;
+
+private:
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_rotations;
 };
 
 }
@@ -0,0 +1,78 @@
+#include <vcam/render/bilinear_upscaler.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace vcam {
+
+static std::uint32_t blend(std::uint32_t a, std::uint32_t b, std::uint32_t weight);
+
+void BilinearUpscaler::resize(int source_width, int source_height, int width, int height) {
+    if (source_width == m_source_width &&
+        source_height == m_source_height &&
+        static_cast<std::size_t>(width) == m_columns.size() &&
+        static_cast<std::size_t>(height) == m_rows.size()) {
+        return;
+    }
+
+    m_source_width = source_width;
+    m_source_height = source_height;
+    calculate_samples(source_width, width, m_columns);
+    calculate_samples(source_height, height, m_rows);
+}
+
+void BilinearUpscaler::upscale_rows(
+    std::uint32_t const* source,
+    int source_stride,
+    Framebuffer const& destination,
+    int first_row,
+    int last_row
+) const {
+    auto const last_column = m_source_width - 1;
+    auto const last_source_row = m_source_height - 1;
+
+    for (int y = first_row; y < last_row; ++y) {
+        auto const row = m_rows[y];
+        auto const* const above = source + static_cast<std::size_t>(row.index) * source_stride;
+        auto const* const below = source + static_cast<std::size_t>(std::min(row.index + 1, last_source_row)) * source_stride;
+        auto* const pixels = destination.pixels + static_cast<std::size_t>(y) * destination.stride;
+
+        for (int x = 0; x < destination.width; ++x) {
+            auto const column = m_columns[x];
+            auto const next = std::min(column.index + 1, last_column);
+
+            pixels[x] = blend(
+                blend(above[column.index], above[next], column.weight),
+                blend(below[column.index], below[next], column.weight),
+                row.weight
+            );
+        }
+    }
+}
+
+// Samples are taken at destination pixel centers mapped into the source.
+// Those before the first source pixel center clamp to it.
+void BilinearUpscaler::calculate_samples(int source_size, int size, std::vector<Sample>& samples) {
+    samples.resize(size);
+
+    auto const scale = static_cast<float>(source_size) / size;
+    for (int i = 0; i < size; ++i) {
+        auto const position = std::max((i + 0.5f) * scale - 0.5f, 0.0f);
+        auto const index = std::min(static_cast<int>(position), source_size - 1);
+        auto const weight = static_cast<std::uint32_t>((position - index) * 256.0f + 0.5f);
+        samples[i] = { index, std::min(weight, 256u) };
+    }
+}
+
+// Blends two packed pixels two channels at a time, each in its own 16 bits
+// so that the weighted sums can't carry into the next channel.
+std::uint32_t blend(std::uint32_t a, std::uint32_t b, std::uint32_t weight) {
+    constexpr std::uint32_t MASK = 0x00FF00FF;
+
+    auto const low = ((a & MASK) * (256 - weight) + (b & MASK) * weight) >> 8;
+    auto const high = (((a >> 8) & MASK) * (256 - weight) + ((b >> 8) & MASK) * weight) >> 8;
+    return (low & MASK) | ((high & MASK) << 8);
+}
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vcam/render/render_target.hh>
+
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+// Scales packed RGBA8888 images up with bilinear filtering. Pixel centers
+// line up, so edges don't shift, and samples beyond the source's border
+// clamp to it.
+class BilinearUpscaler {
+public:
+    // Prepares for source_width x source_height images scaled to width x
+    // height. Does nothing if the sizes haven't changed.
+    void resize(int source_width, int source_height, int width, int height);
+
+    // Writes destination rows [first_row, last_row) from the source, whose
+    // rows are source_stride pixels apart. Rows can be written in parallel.
+    void upscale_rows(
+        std::uint32_t const* source,
+        int source_stride,
+        Framebuffer const& destination,
+        int first_row,
+        int last_row
+    ) const;
+
+private:
+    // Source pixel before the sample and the weight of the one after it,
+    // out of 256.
+    struct Sample {
+        int index;
+        std::uint32_t weight;
+    };
+
+    int m_source_width = 0;
+    int m_source_height = 0;
+    std::vector<Sample> m_columns;
+    std::vector<Sample> m_rows;
+
+    static void calculate_samples(int source_size, int size, std::vector<Sample>& samples);
+};
+
+}
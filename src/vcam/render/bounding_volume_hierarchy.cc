@@ -0,0 +1,173 @@
+#include <vcam/render/bounding_volume_hierarchy.hh>
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace vcam {
+
+void BoundingVolumeHierarchy::insert(Item item, BoundingBox const& bounds) {
+    if (item >= m_item_bounds.size()) {
+        m_item_bounds.resize(item + 1);
+        m_item_leaves.resize(item + 1, NO_NODE);
+    }
+
+    m_item_bounds[item] = bounds;
+    m_item_leaves[item] = 0;
+    ++m_size;
+    m_needs_rebuild = true;
+}
+
+void BoundingVolumeHierarchy::update(Item item, BoundingBox const& bounds) {
+    m_item_bounds[item] = bounds;
+    if (!m_needs_rebuild) {
+        m_dirty_leaves.push_back(m_item_leaves[item]);
+    }
+}
+
+void BoundingVolumeHierarchy::remove(Item item) {
+    m_item_leaves[item] = NO_NODE;
+    --m_size;
+    m_needs_rebuild = true;
+}
+
+void BoundingVolumeHierarchy::commit() {
+    if (m_needs_rebuild) {
+        rebuild();
+    } else {
+        for (auto const leaf : m_dirty_leaves) {
+            refit(leaf);
+        }
+    }
+
+    m_dirty_leaves.clear();
+    m_needs_rebuild = false;
+}
+
+void BoundingVolumeHierarchy::query(Frustum const& frustum, std::vector<Item>& items) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    // Splits are made at the median, so the depth stays logarithmic.
+    std::array<std::pair<std::uint32_t, std::uint8_t>, 64> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = { 0, Frustum::ALL_PLANES };
+
+    while (stack_size > 0) {
+        auto [index, plane_mask] = stack[--stack_size];
+        auto const& node = m_nodes[index];
+
+        if (test_bounding_box(frustum, node.bounds, plane_mask) == FrustumTest::OUTSIDE) {
+            continue;
+        }
+
+        if (node.item_count == 0) {
+            stack[stack_size++] = { node.offset, plane_mask };
+            stack[stack_size++] = { index + 1, plane_mask };
+            continue;
+        }
+
+        for (auto i = node.offset; i < node.offset + node.item_count; ++i) {
+            auto const item = m_leaf_items[i];
+            auto item_plane_mask = plane_mask;
+            if (test_bounding_box(frustum, m_item_bounds[item], item_plane_mask) != FrustumTest::OUTSIDE) {
+                items.push_back(item);
+            }
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::rebuild() {
+    m_nodes.clear();
+    m_leaf_items.clear();
+
+    std::vector<glm::vec3> centroids(m_item_bounds.size());
+    for (Item item = 0; item < m_item_bounds.size(); ++item) {
+        if (m_item_leaves[item] == NO_NODE) {
+            continue;
+        }
+
+        m_leaf_items.push_back(item);
+        centroids[item] = (m_item_bounds[item].min + m_item_bounds[item].max) * 0.5f;
+    }
+
+    if (m_leaf_items.empty()) {
+        return;
+    }
+
+    m_nodes.reserve(m_leaf_items.size() * 2);
+    build_node(NO_NODE, 0, static_cast<std::uint32_t>(m_leaf_items.size()), centroids);
+}
+
+std::uint32_t BoundingVolumeHierarchy::build_node(
+    std::uint32_t parent,
+    std::uint32_t first,
+    std::uint32_t last,
+    std::vector<glm::vec3> const& centroids
+) {
+    auto const index = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.push_back({ m_item_bounds[m_leaf_items[first]], parent, first, last - first });
+
+    auto bounds = m_item_bounds[m_leaf_items[first]];
+    auto centroid_min = centroids[m_leaf_items[first]];
+    auto centroid_max = centroid_min;
+    for (auto i = first; i < last; ++i) {
+        auto const item = m_leaf_items[i];
+        bounds = merge_bounding_boxes(bounds, m_item_bounds[item]);
+        centroid_min = glm::min(centroid_min, centroids[item]);
+        centroid_max = glm::max(centroid_max, centroids[item]);
+    }
+    m_nodes[index].bounds = bounds;
+
+    if (last - first <= MAX_LEAF_ITEMS) {
+        for (auto i = first; i < last; ++i) {
+            m_item_leaves[m_leaf_items[i]] = index;
+        }
+        return index;
+    }
+
+    // Halves the items along the axis their centroids spread the most on.
+    auto const spread = centroid_max - centroid_min;
+    auto axis = 0;
+    if (spread.y > spread[axis]) {
+        axis = 1;
+    }
+    if (spread.z > spread[axis]) {
+        axis = 2;
+    }
+
+    auto const middle = first + (last - first) / 2;
+    std::nth_element(
+        m_leaf_items.begin() + first,
+        m_leaf_items.begin() + middle,
+        m_leaf_items.begin() + last,
+        [&](Item a, Item b) {
+            return centroids[a][axis] < centroids[b][axis];
+        });
+
+    build_node(index, first, middle, centroids);
+    auto const second_child = build_node(index, middle, last, centroids);
+
+    m_nodes[index].offset = second_child;
+    m_nodes[index].item_count = 0;
+
+    return index;
+}
+
+void BoundingVolumeHierarchy::refit(std::uint32_t leaf) {
+    auto& node = m_nodes[leaf];
+
+    auto bounds = m_item_bounds[m_leaf_items[node.offset]];
+    for (auto i = node.offset + 1; i < node.offset + node.item_count; ++i) {
+        bounds = merge_bounding_boxes(bounds, m_item_bounds[m_leaf_items[i]]);
+    }
+    node.bounds = bounds;
+
+    for (auto index = node.parent; index != NO_NODE; index = m_nodes[index].parent) {
+        auto& parent = m_nodes[index];
+        parent.bounds = merge_bounding_boxes(m_nodes[index + 1].bounds, m_nodes[parent.offset].bounds);
+    }
+}
+
+}
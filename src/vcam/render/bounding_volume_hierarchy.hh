@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vcam/render/bounding_volumes.hh>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+// Binary tree of bounding boxes over a set of items identified by small
+// integers. Inserting or removing items rebuilds the tree, moving them only
+// refits the boxes on the path from their leaf to the root, so a mostly
+// static set costs nothing to maintain.
+class BoundingVolumeHierarchy {
+public:
+    using Item = std::uint32_t;
+
+    void insert(Item item, BoundingBox const& bounds);
+    void update(Item item, BoundingBox const& bounds);
+    void remove(Item item);
+
+    // Brings the tree up to date with every insert, update and remove since
+    // the last commit.
+    void commit();
+
+    // Appends the items whose bounds aren't entirely outside the frustum.
+    // Subtrees entirely inside it are appended without further tests.
+    void query(Frustum const& frustum, std::vector<Item>& items) const;
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+private:
+    static constexpr std::uint32_t MAX_LEAF_ITEMS = 4;
+    static constexpr std::uint32_t NO_NODE = ~std::uint32_t(0);
+
+    // Nodes are stored in depth-first order, so the first child of an
+    // internal node directly follows it.
+    struct Node {
+        BoundingBox bounds;
+        std::uint32_t parent;
+
+        // Index of the second child for internal nodes, of the first item
+        // in m_leaf_items for leaves.
+        std::uint32_t offset;
+
+        // Zero for internal nodes.
+        std::uint32_t item_count;
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<Item> m_leaf_items;
+
+    // Indexed by item. Items which aren't in the set have no leaf, items
+    // inserted since the last rebuild have leaf 0 until the next one.
+    std::vector<BoundingBox> m_item_bounds;
+    std::vector<std::uint32_t> m_item_leaves;
+
+    std::vector<std::uint32_t> m_dirty_leaves;
+    std::size_t m_size = 0;
+    bool m_needs_rebuild = false;
+
+    void rebuild();
+    std::uint32_t build_node(std::uint32_t parent, std::uint32_t first, std::uint32_t last, std::vector<glm::vec3> const& centroids);
+    void refit(std::uint32_t leaf);
+};
+
+}
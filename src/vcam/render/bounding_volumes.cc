@@ -0,0 +1,107 @@
+#include <vcam/render/bounding_volumes.hh>
+
+#include <algorithm>
+
+namespace vcam {
+
+BoundingBox calculate_bounding_box(std::span<glm::vec3 const> points) {
+    if (points.empty()) {
+        return { glm::vec3(0.0f), glm::vec3(0.0f) };
+    }
+
+    BoundingBox box = { points.front(), points.front() };
+    for (auto const& point : points) {
+        box.min = glm::min(box.min, point);
+        box.max = glm::max(box.max, point);
+    }
+
+    return box;
+}
+
+BoundingSphere calculate_bounding_sphere(std::span<glm::vec3 const> points, BoundingBox const& box) {
+    auto const center = (box.min + box.max) * 0.5f;
+
+    auto radius = 0.0f;
+    for (auto const& point : points) {
+        radius = std::max(radius, glm::length(point - center));
+    }
+
+    return { center, radius };
+}
+
+BoundingBox merge_bounding_boxes(BoundingBox const& a, BoundingBox const& b) {
+    return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+BoundingBox transform_bounding_box(BoundingBox const& box, glm::mat4 const& transform) {
+    auto const center = (box.min + box.max) * 0.5f;
+    auto const extent = (box.max - box.min) * 0.5f;
+
+    // Each axis of the transformed box reaches as far as the absolute
+    // values of the transformed half extents add up to.
+    auto const linear = glm::mat3(transform);
+    auto const absolute = glm::mat3(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+
+    auto const transformed_center = glm::vec3(transform * glm::vec4(center, 1.0f));
+    auto const transformed_extent = absolute * extent;
+
+    return { transformed_center - transformed_extent, transformed_center + transformed_extent };
+}
+
+Frustum calculate_frustum(glm::mat4 const& to_projection_transform) {
+    // Rows of the transform, each one yields a clip space coordinate.
+    auto const row = [&](int i) {
+        return glm::vec4(
+            to_projection_transform[0][i],
+            to_projection_transform[1][i],
+            to_projection_transform[2][i],
+            to_projection_transform[3][i]
+        );
+        };
+
+    auto const x = row(0);
+    auto const y = row(1);
+    auto const z = row(2);
+    auto const w = row(3);
+
+    return { {
+        w + x,
+        w - x,
+        w + y,
+        w - y,
+        w - z,
+        z
+    } };
+}
+
+FrustumTest test_bounding_box(Frustum const& frustum, BoundingBox const& box, std::uint8_t& plane_mask) {
+    auto const center = (box.min + box.max) * 0.5f;
+    auto const extent = (box.max - box.min) * 0.5f;
+
+    for (std::size_t i = 0; i < frustum.planes.size(); ++i) {
+        auto const bit = static_cast<std::uint8_t>(1 << i);
+        if ((plane_mask & bit) == 0) {
+            continue;
+        }
+
+        auto const& plane = frustum.planes[i];
+        auto const normal = glm::vec3(plane);
+
+        // Distance of the center and the largest distance of a corner from
+        // it along the plane normal, both scaled by the normal's length.
+        auto const distance = glm::dot(normal, center) + plane.w;
+        auto const reach = glm::dot(glm::abs(normal), extent);
+
+        if (distance + reach < 0.0f) {
+            return FrustumTest::OUTSIDE;
+        }
+
+        if (distance - reach >= 0.0f) {
+            plane_mask &= static_cast<std::uint8_t>(~bit);
+        }
+    }
+
+    return plane_mask == 0 ? FrustumTest::INSIDE : FrustumTest::INTERSECTING;
+}
+
+}
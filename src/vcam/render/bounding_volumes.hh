@@ -0,0 +1,55 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace vcam {
+
+struct BoundingSphere {
+    glm::vec3 center;
+    float radius;
+};
+
+struct BoundingBox {
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+// Planes of a view frustum as (normal, distance), with normals pointing
+// inwards, so point p is on the inner side of plane q if
+// dot(q, vec4(p, 1)) >= 0. The normals aren't normalized.
+struct Frustum {
+    static constexpr std::uint8_t ALL_PLANES = 0b111111;
+
+    std::array<glm::vec4, 6> planes;
+};
+
+enum class FrustumTest {
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
+BoundingBox calculate_bounding_box(std::span<glm::vec3 const> points);
+
+// Centered on the points' bounding box, which is loose but cheap.
+BoundingSphere calculate_bounding_sphere(std::span<glm::vec3 const> points, BoundingBox const& box);
+
+BoundingBox merge_bounding_boxes(BoundingBox const& a, BoundingBox const& b);
+
+// Smallest axis-aligned box containing the transformed box.
+BoundingBox transform_bounding_box(BoundingBox const& box, glm::mat4 const& transform);
+
+// Extracts the frustum of a transform into clip space, with 0 <= z <= w,
+// in the space the transform starts from.
+Frustum calculate_frustum(glm::mat4 const& to_projection_transform);
+
+// Tests the box against the planes in plane_mask, one bit per plane. Bits of
+// planes the box lies entirely inside of are cleared, so boxes nested within
+// it can skip them.
+FrustumTest test_bounding_box(Frustum const& frustum, BoundingBox const& box, std::uint8_t& plane_mask);
+
+}
@@ -1,28 +1,73 @@
+#include <vcam/core/math.hh>
 #include <vcam/render/camera_component.hh>
 
 #include <SDL3/SDL_keyboard.h>
 
+#include <algorithm>
+
 namespace vcam {
 
-void CameraComponent::on_update(Entity& entity, float dt) {
+void CameraComponents::insert(Entity entity, float vfov) {
+    insert_entity(entity);
+    vfovs.push_back(vfov);
+    previous_vfovs.push_back(vfov);
+}
+
+void CameraComponents::remove(Entity entity) {
+    if (!contains(entity)) {
+        return;
+    }
+
+    remove_swapped(remove_entity(entity), vfovs, previous_vfovs);
+}
+
+void CameraComponentSystem::on_update(Scene& scene, float dt) {
     auto const* keyboard = SDL_GetKeyboardState(nullptr);
 
+    // Degrees per millisecond.
+    auto const speed = 0.03f;
+
+    auto zoom = 0.0f;
     if (keyboard[SDL_SCANCODE_MINUS]) {
-        m_vfov += 0.5f;
+        zoom += speed * dt;
     }
 
     if (keyboard[SDL_SCANCODE_EQUALS]) {
-        m_vfov -= 0.5f;
+        zoom -= speed * dt;
     }
 
-    m_vfov = std::max(std::min(m_vfov, 90.0f), 1.0f);
+    auto& cameras = scene.pool<CameraComponents>();
+    for (std::size_t i = 0; i < cameras.size(); ++i) {
+        cameras.previous_vfovs[i] = cameras.vfovs[i];
+        cameras.vfovs[i] = std::clamp(cameras.vfovs[i] + zoom, 1.0f, 90.0f);
+    }
+}
+
+void CameraComponentSystem::on_render(Scene& scene, float t) {
+    auto& cameras = scene.pool<CameraComponents>();
+    auto const& transforms = scene.transforms();
+
+    auto const entities = cameras.entities();
+    for (std::size_t i = 0; i < cameras.size(); ++i) {
+        auto const& local_to_scene_transform = transforms.local_to_scene_transform(transforms.index(entities[i]));
 
-    Camera camera = {
-        .position = entity.position(),
-        .rotation = entity.rotation(),
-        .vfov = m_vfov
-    };
-    m_render_system.camera(camera);
+        // Cameras follow their parents' rotations, but not their scales.
+        auto const rotation_matrix = glm::mat4(glm::mat3(
+            glm::normalize(glm::vec3(local_to_scene_transform[0])),
+            glm::normalize(glm::vec3(local_to_scene_transform[1])),
+            glm::normalize(glm::vec3(local_to_scene_transform[2]))
+        ));
+
+        glm::vec3 rotation;
+        glm::extractEulerAngleYXZ(rotation_matrix, rotation.y, rotation.x, rotation.z);
+
+        Camera camera = {
+            .position = glm::vec3(local_to_scene_transform[3]),
+            .rotation = rotation,
+            .vfov = cameras.previous_vfovs[i] + (cameras.vfovs[i] - cameras.previous_vfovs[i]) * t
+        };
+        cameras.render_system().camera(camera);
+    }
 }
 
 }
@@ -1,19 +1,43 @@
 #pragma once
 
-#include <vcam/core/entity.hh>
+#include <vcam/core/component_pool.hh>
+#include <vcam/core/scene.hh>
 #include <vcam/render/render_system.hh>
 
+#include <vector>
+
 namespace vcam {
 
-class CameraComponent : public IComponent {
+// Cameras at the transforms of entities, with their vertical fields of view
+// in degrees. The render system sees through the last one rendered.
+class CameraComponents : public ComponentPool {
 public:
-    CameraComponent(RenderSystem& render_system) : m_render_system{ render_system } { }
+    std::vector<float> vfovs;
+
+    // As of the start of the last update.
+    std::vector<float> previous_vfovs;
+
+    explicit CameraComponents(RenderSystem& render_system)
+        : m_render_system(render_system) { }
+
+    RenderSystem& render_system() {
+        return m_render_system;
+    }
 
-    virtual void on_update(Entity& entity, float dt) override;
+    void insert(Entity entity, float vfov = 30.0f);
+
+    virtual void remove(Entity entity) override;
 
 private:
     RenderSystem& m_render_system;
-    float m_vfov = 30.0f;
+};
+
+// Zooms cameras with the plus and minus keys, and hands them to the render
+// system at their interpolated transforms.
+class CameraComponentSystem : public ISystem {
+public:
+    virtual void on_update(Scene& scene, float dt) override;
+    virtual void on_render(Scene& scene, float t) override;
 };
 
 }
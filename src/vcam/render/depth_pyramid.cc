@@ -0,0 +1,116 @@
+#include <vcam/render/depth_pyramid.hh>
+
+#include <algorithm>
+#include <limits>
+
+namespace vcam {
+
+DepthPyramid::DepthPyramid(int tile_size) : m_tile_levels(0) {
+    for (auto cell_size = BASE_CELL_SIZE; cell_size <= tile_size; cell_size *= 2) {
+        ++m_tile_levels;
+    }
+}
+
+void DepthPyramid::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_levels.clear();
+
+    auto cell_size = BASE_CELL_SIZE;
+    while (true) {
+        auto const level_width = (width + cell_size - 1) / cell_size;
+        auto const level_height = (height + cell_size - 1) / cell_size;
+
+        m_levels.push_back({
+            level_width,
+            level_height,
+            std::vector<float>(static_cast<std::size_t>(level_width) * level_height, -std::numeric_limits<float>::infinity())
+            });
+
+        if (level_width == 1 && level_height == 1) {
+            break;
+        }
+        cell_size *= 2;
+    }
+}
+
+void DepthPyramid::update_tile(float const* depth_buffer, int min_x, int min_y, int max_x, int max_y) {
+    auto& base = m_levels[0];
+
+    for (auto cy = min_y / BASE_CELL_SIZE; cy <= max_y / BASE_CELL_SIZE; ++cy) {
+        for (auto cx = min_x / BASE_CELL_SIZE; cx <= max_x / BASE_CELL_SIZE; ++cx) {
+            auto const x0 = cx * BASE_CELL_SIZE;
+            auto const x1 = std::min(x0 + BASE_CELL_SIZE, m_width);
+            auto const y0 = cy * BASE_CELL_SIZE;
+            auto const y1 = std::min(y0 + BASE_CELL_SIZE, m_height);
+
+            auto farthest = std::numeric_limits<float>::infinity();
+            for (auto y = y0; y < y1; ++y) {
+                auto const* const depth_row = depth_buffer + static_cast<std::size_t>(y) * m_width;
+                farthest = std::min(farthest, *std::min_element(depth_row + x0, depth_row + x1));
+            }
+
+            base.depths[static_cast<std::size_t>(cy) * base.width + cx] = farthest;
+        }
+    }
+
+    for (std::size_t level = 1; level < std::min<std::size_t>(m_tile_levels, m_levels.size()); ++level) {
+        update_level(level, min_x, min_y, max_x, max_y);
+    }
+}
+
+void DepthPyramid::update_coarse_levels() {
+    for (auto level = static_cast<std::size_t>(std::max(m_tile_levels, 1)); level < m_levels.size(); ++level) {
+        update_level(level, 0, 0, m_width - 1, m_height - 1);
+    }
+}
+
+void DepthPyramid::update_level(std::size_t level, int min_x, int min_y, int max_x, int max_y) {
+    auto const& finer = m_levels[level - 1];
+    auto& coarser = m_levels[level];
+    auto const cell_size = BASE_CELL_SIZE << level;
+
+    for (auto cy = min_y / cell_size; cy <= max_y / cell_size; ++cy) {
+        for (auto cx = min_x / cell_size; cx <= max_x / cell_size; ++cx) {
+            auto farthest = std::numeric_limits<float>::infinity();
+
+            for (auto fy = cy * 2; fy < std::min(cy * 2 + 2, finer.height); ++fy) {
+                for (auto fx = cx * 2; fx < std::min(cx * 2 + 2, finer.width); ++fx) {
+                    farthest = std::min(farthest, finer.depths[static_cast<std::size_t>(fy) * finer.width + fx]);
+                }
+            }
+
+            coarser.depths[static_cast<std::size_t>(cy) * coarser.width + cx] = farthest;
+        }
+    }
+}
+
+bool DepthPyramid::is_occluded(int min_x, int min_y, int max_x, int max_y, float depth) const {
+    // The coarsest level whose cells are at least as large as the rectangle
+    // covers it with at most two cells per axis.
+    auto const extent = std::max(max_x - min_x, max_y - min_y) + 1;
+
+    std::size_t level = 0;
+    while (level + 1 < m_levels.size() && (BASE_CELL_SIZE << level) < extent) {
+        ++level;
+    }
+
+    auto const& cells = m_levels[level];
+    auto const cell_size = BASE_CELL_SIZE << level;
+
+    for (auto cy = min_y / cell_size; cy <= max_y / cell_size; ++cy) {
+        for (auto cx = min_x / cell_size; cx <= max_x / cell_size; ++cx) {
+            if (!(depth < cells.depths[static_cast<std::size_t>(cy) * cells.width + cx])) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
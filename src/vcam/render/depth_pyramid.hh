@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace vcam {
+
+// Hierarchical view of a reverse depth buffer. Each cell holds the farthest
+// depth, i.e. the smallest value, of the pixels it covers, so anything
+// farther than that is hidden everywhere in the cell. The finest level has
+// BASE_CELL_SIZE pixel cells and every following level halves the
+// resolution down to a single cell.
+class DepthPyramid {
+public:
+    static constexpr int BASE_CELL_SIZE = 8;
+
+    // Levels whose cells fit within a tile are updated tile by tile, so
+    // tiles can maintain their part of the pyramid in parallel.
+    explicit DepthPyramid(int tile_size);
+
+    void resize(int width, int height);
+
+    // Rebuilds the levels within the tile covering pixels [min_x, max_x] x
+    // [min_y, max_y] from the depth buffer.
+    void update_tile(float const* depth_buffer, int min_x, int min_y, int max_x, int max_y);
+
+    // Rebuilds the levels coarser than a tile, once every tile is updated.
+    void update_coarse_levels();
+
+    // Whether every pixel of [min_x, max_x] x [min_y, max_y] already holds
+    // a depth nearer than the given one.
+    bool is_occluded(int min_x, int min_y, int max_x, int max_y, float depth) const;
+
+private:
+    struct Level {
+        int width;
+        int height;
+        std::vector<float> depths;
+    };
+
+    int m_tile_levels;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<Level> m_levels;
+
+    void update_level(std::size_t level, int min_x, int min_y, int max_x, int max_y);
+};
+
+}
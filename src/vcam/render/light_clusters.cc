@@ -0,0 +1,94 @@
+#include <vcam/render/light_clusters.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vcam {
+
+void LightClusters::reset(int width, int height, float z_near, float z_far) {
+    m_columns = (width + m_tile_size - 1) / m_tile_size;
+    m_rows = (height + m_tile_size - 1) / m_tile_size;
+
+    m_slice_scale = DEPTH_SLICES / std::log(z_far / z_near);
+    m_slice_bias = -std::log(z_near) * m_slice_scale;
+
+    m_entries.clear();
+    m_global_lights.clear();
+}
+
+void LightClusters::add_light(std::uint32_t light, int min_x, int min_y, int max_x, int max_y, float min_z, float max_z) {
+    m_entries.push_back({
+        light,
+        min_x / m_tile_size,
+        min_y / m_tile_size,
+        std::min(max_x / m_tile_size, m_columns - 1),
+        std::min(max_y / m_tile_size, m_rows - 1),
+        calculate_slice(min_z),
+        calculate_slice(max_z)
+        });
+}
+
+void LightClusters::add_global_light(std::uint32_t light) {
+    m_global_lights.push_back(light);
+}
+
+void LightClusters::commit() {
+    auto const cluster_count = static_cast<std::size_t>(m_columns) * m_rows * DEPTH_SLICES;
+    auto const cluster_index = [&](int column, int row, int slice) {
+        return (static_cast<std::size_t>(row) * m_columns + column) * DEPTH_SLICES + slice;
+        };
+
+    // Counts the lights of every cluster, turns the counts into offsets,
+    // then scatters the lights, moving each offset to the end of its list.
+    // Shifting the offsets back afterwards restores their starts.
+    m_cluster_offsets.assign(cluster_count + 1, 0);
+    for (auto const& entry : m_entries) {
+        for (int row = entry.min_row; row <= entry.max_row; ++row) {
+            for (int column = entry.min_column; column <= entry.max_column; ++column) {
+                for (int slice = entry.min_slice; slice <= entry.max_slice; ++slice) {
+                    ++m_cluster_offsets[cluster_index(column, row, slice) + 1];
+                }
+            }
+        }
+    }
+
+    for (std::size_t i = 1; i <= cluster_count; ++i) {
+        m_cluster_offsets[i] += m_cluster_offsets[i - 1];
+    }
+
+    m_cluster_lights.resize(m_cluster_offsets[cluster_count]);
+    for (auto const& entry : m_entries) {
+        for (int row = entry.min_row; row <= entry.max_row; ++row) {
+            for (int column = entry.min_column; column <= entry.max_column; ++column) {
+                for (int slice = entry.min_slice; slice <= entry.max_slice; ++slice) {
+                    m_cluster_lights[m_cluster_offsets[cluster_index(column, row, slice)]++] = entry.light;
+                }
+            }
+        }
+    }
+
+    std::copy_backward(m_cluster_offsets.begin(), m_cluster_offsets.end() - 1, m_cluster_offsets.end());
+    m_cluster_offsets[0] = 0;
+}
+
+std::span<std::uint32_t const> LightClusters::lights(int x, int y, float z) const {
+    auto const column = x / m_tile_size;
+    auto const row = y / m_tile_size;
+    auto const cluster = (static_cast<std::size_t>(row) * m_columns + column) * DEPTH_SLICES + calculate_slice(z);
+
+    auto const first = m_cluster_offsets[cluster];
+    auto const last = m_cluster_offsets[cluster + 1];
+    return { m_cluster_lights.data() + first, last - first };
+}
+
+// Depths outside the near and far planes fall into the first and last slice.
+int LightClusters::calculate_slice(float z) const {
+    if (!(z > 0.0f)) {
+        return 0;
+    }
+
+    auto const slice = std::log(z) * m_slice_scale + m_slice_bias;
+    return std::clamp(static_cast<int>(std::min(slice, static_cast<float>(DEPTH_SLICES))), 0, DEPTH_SLICES - 1);
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vcam {
+
+// Lists the lights reaching each cluster of the view frustum, a screen tile
+// times a slice of view depth, so that fragments only evaluate the lights
+// near them. Slices are spaced exponentially between the near and far
+// planes, which keeps clusters about as deep as they're wide. Lights without
+// a bounded radius reach every cluster and are kept in a list of their own.
+class LightClusters {
+public:
+    static constexpr int DEPTH_SLICES = 64;
+
+    explicit LightClusters(int tile_size) : m_tile_size(tile_size) { }
+
+    // Starts a frame without lights.
+    void reset(int width, int height, float z_near, float z_far);
+
+    // Adds the light to every cluster overlapping pixels [min_x, max_x] x
+    // [min_y, max_y] and view depths [min_z, max_z].
+    void add_light(std::uint32_t light, int min_x, int min_y, int max_x, int max_y, float min_z, float max_z);
+
+    // Adds a light reaching every pixel and depth.
+    void add_global_light(std::uint32_t light);
+
+    // Builds the lists, once every light is added.
+    void commit();
+
+    // Lights reaching pixel (x, y) at view depth z, in the order they were
+    // added.
+    std::span<std::uint32_t const> lights(int x, int y, float z) const;
+
+    // Lights reaching every cluster, in the order they were added.
+    std::span<std::uint32_t const> global_lights() const {
+        return m_global_lights;
+    }
+
+    // Light list entries summed over all clusters.
+    std::size_t size() const {
+        return m_cluster_lights.size();
+    }
+
+private:
+    struct Entry {
+        std::uint32_t light;
+        int min_column;
+        int min_row;
+        int max_column;
+        int max_row;
+        int min_slice;
+        int max_slice;
+    };
+
+    int m_tile_size;
+    int m_columns = 0;
+    int m_rows = 0;
+
+    // Slice of view depth z is log(z) * m_slice_scale + m_slice_bias.
+    float m_slice_scale = 0.0f;
+    float m_slice_bias = 0.0f;
+
+    std::vector<Entry> m_entries;
+    std::vector<std::uint32_t> m_global_lights;
+
+    // Lights of cluster i are m_cluster_lights[m_cluster_offsets[i],
+    // m_cluster_offsets[i + 1]). Clusters are ordered by tile, then slice.
+    std::vector<std::uint32_t> m_cluster_offsets;
+    std::vector<std::uint32_t> m_cluster_lights;
+
+    int calculate_slice(float z) const;
+};
+
+}
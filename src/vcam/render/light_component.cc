@@ -1,34 +1,101 @@
 #include <vcam/core/math.hh>
 #include <vcam/render/light_component.hh>
 
-#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_keyboard.h>
 
 namespace vcam {
 
 static glm::vec3 calculate_translation_delta(bool const* keyboard, float dt);
 
-void LightComponent::on_update(Entity& entity, float dt) {
-    auto* const keyboard = SDL_GetKeyboardState(nullptr);
+LightComponents::~LightComponents() {
+    for (auto const& light : lights) {
+        if (light) {
+            m_render_system.remove_light(*light);
+        }
+    }
+}
+
+void LightComponents::insert(
+    Entity entity,
+    glm::vec3 ambient_intensity,
+    glm::vec3 specular_intensity,
+    glm::vec3 diffuse_intensity,
+    float radius
+) {
+    insert_entity(entity);
+    ambient_intensities.push_back(ambient_intensity);
+    specular_intensities.push_back(specular_intensity);
+    diffuse_intensities.push_back(diffuse_intensity);
+    radii.push_back(radius);
+    lights.push_back(std::nullopt);
+}
+
+void LightComponents::remove(Entity entity) {
+    if (!contains(entity)) {
+        return;
+    }
+
+    auto const& light = lights[index(entity)];
+    if (light) {
+        m_render_system.remove_light(*light);
+    }
 
-    auto rotation = entity.rotation();
-    auto position = entity.position();
+    remove_swapped(
+        remove_entity(entity),
+        ambient_intensities,
+        specular_intensities,
+        diffuse_intensities,
+        radii,
+        lights
+    );
+}
 
+void LightComponentSystem::on_update(Scene& scene, float dt) {
+    auto* const keyboard = SDL_GetKeyboardState(nullptr);
     auto const dtr = calculate_translation_delta(keyboard, dt);
-    auto const local_delta_transform = calculate_transform_matrix(dtr, glm::vec3(0.0f), glm::vec3(1.0f));
-    auto const local_to_scene_transform = calculate_transform_matrix(position, rotation, glm::vec3(1.0f));
-    auto const new_local_to_scene_transform = local_to_scene_transform * local_delta_transform;
+    if (dtr == glm::vec3(0.0f)) {
+        return;
+    }
 
-    auto const new_position = glm::vec3(new_local_to_scene_transform * glm::vec4(glm::vec3(0.0f), 1.0f));
+    auto& transforms = scene.transforms();
+    for (auto const entity : scene.pool<LightComponents>().entities()) {
+        auto const transform = transforms.index(entity);
 
-    entity.position(new_position);
+        auto const local_delta_transform = calculate_transform_matrix(dtr, glm::vec3(0.0f), glm::vec3(1.0f));
+        auto const local_to_parent_transform = calculate_transform_matrix(
+            transforms.position(transform),
+            transforms.rotation(transform),
+            glm::vec3(1.0f)
+        );
+        auto const new_local_to_parent_transform = local_to_parent_transform * local_delta_transform;
 
-    m_render_system.light(
-        Light{
-            entity.position(),
-            m_ambient_intensity,
-            m_specular_intensity,
-            m_diffuse_intensity
-        });
+        transforms.position(transform, glm::vec3(new_local_to_parent_transform * glm::vec4(glm::vec3(0.0f), 1.0f)));
+    }
+}
+
+void LightComponentSystem::on_render(Scene& scene, float t) {
+    auto& lights = scene.pool<LightComponents>();
+    auto const& transforms = scene.transforms();
+    auto& render_system = lights.render_system();
+
+    auto const entities = lights.entities();
+    for (std::size_t i = 0; i < lights.size(); ++i) {
+        auto const& local_to_scene_transform = transforms.local_to_scene_transform(transforms.index(entities[i]));
+        auto const light = Light{
+            glm::vec3(local_to_scene_transform[3]),
+            lights.ambient_intensities[i],
+            lights.specular_intensities[i],
+            lights.diffuse_intensities[i],
+            lights.radii[i]
+        };
+
+        auto& id = lights.lights[i];
+        if (id) {
+            render_system.update_light(*id, light);
+        } else {
+            id = render_system.add_light(light);
+        }
+    }
 }
 
 glm::vec3 calculate_translation_delta(bool const* keyboard, float dt) {
@@ -1,30 +1,58 @@
 #pragma once
 
-#include <vcam/core/entity.hh>
-#include <vcam/render/model.hh>
+#include <vcam/core/component_pool.hh>
+#include <vcam/core/scene.hh>
 #include <vcam/render/render_system.hh>
 
+#include <glm/glm.hpp>
+
+#include <limits>
+#include <optional>
+#include <vector>
+
 namespace vcam {
 
-class LightComponent : public IComponent {
+// Point lights at the positions of entities. Lights are removed from the
+// render system along with their components.
+class LightComponents : public ComponentPool {
 public:
-    explicit LightComponent(
-        RenderSystem& render_system,
+    std::vector<glm::vec3> ambient_intensities;
+    std::vector<glm::vec3> specular_intensities;
+    std::vector<glm::vec3> diffuse_intensities;
+    std::vector<float> radii;
+
+    // Added to the render system when first rendered.
+    std::vector<std::optional<LightId>> lights;
+
+    explicit LightComponents(RenderSystem& render_system)
+        : m_render_system(render_system) { }
+
+    ~LightComponents();
+
+    RenderSystem& render_system() {
+        return m_render_system;
+    }
+
+    void insert(
+        Entity entity,
         glm::vec3 ambient_intensity,
         glm::vec3 specular_intensity,
-        glm::vec3 diffuse_intensity
-    ) : m_render_system(render_system),
-        m_ambient_intensity{ ambient_intensity },
-        m_specular_intensity{ specular_intensity },
-        m_diffuse_intensity{ diffuse_intensity } { }
+        glm::vec3 diffuse_intensity,
+        float radius = std::numeric_limits<float>::infinity()
+    );
 
-    virtual void on_update(Entity& entity, float dt) override;
+    virtual void remove(Entity entity) override;
 
 private:
     RenderSystem& m_render_system;
-    glm::vec3 m_ambient_intensity;
-    glm::vec3 m_specular_intensity;
-    glm::vec3 m_diffuse_intensity;
+};
+
+// Moves lights sideways with the numpad, and hands them to the render
+// system at their interpolated positions.
+class LightComponentSystem : public ISystem {
+public:
+    virtual void on_update(Scene& scene, float dt) override;
+    virtual void on_render(Scene& scene, float t) override;
 };
 
 }
@@ -0,0 +1,38 @@
+#include <vcam/render/materials.hh>
+
+#include <utility>
+
+namespace vcam {
+
+Material create_gold_material() {
+    return Material(
+        glm::vec3(1.0f, 0.843f, 0.0f),
+        100.0f,
+        glm::vec3(0.628f, 0.555f, 0.366f),
+        glm::vec3(0.75164f, 0.60648f, 0.22648f),
+        glm::vec3(0.24725f, 0.1995f, 0.0745f)
+    );
+}
+
+Material create_plastic_material() {
+    return Material(
+        glm::vec3(0.8f, 0.1f, 0.1f),
+        10.0f,
+        glm::vec3(0.5f, 0.5f, 0.5f),
+        glm::vec3(0.8f, 0.1f, 0.1f),
+        glm::vec3(0.1f, 0.01f, 0.01f)
+    );
+}
+
+Material create_textured_material(std::shared_ptr<Texture const> texture) {
+    return Material(
+        glm::vec3(1.0f, 1.0f, 1.0f),
+        20.0f,
+        glm::vec3(0.3f, 0.3f, 0.3f),
+        glm::vec3(0.8f, 0.8f, 0.8f),
+        glm::vec3(0.2f, 0.2f, 0.2f),
+        std::move(texture)
+    );
+}
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <memory>
+
+namespace vcam {
+
+Material create_gold_material();
+Material create_plastic_material();
+
+// White, so the texture gives the color, and slightly glossy.
+Material create_textured_material(std::shared_ptr<Texture const> texture);
+
+}
@@ -0,0 +1,216 @@
+#include <vcam/render/mesh_file.hh>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <span>
+
+namespace vcam {
+
+static_assert(std::endian::native == std::endian::little, "Mesh files are mapped as little-endian");
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float) && sizeof(glm::vec2) == 2 * sizeof(float));
+static_assert(sizeof(Triangle) == 3 * sizeof(VertexIndex));
+
+static constexpr std::array<char, 8> MAGIC = { 'V', 'C', 'A', 'M', 'M', 'E', 'S', 'H' };
+
+// Wide enough for the widest SIMD loads of the vertex kernels.
+static constexpr std::uint64_t SECTION_ALIGNMENT = 64;
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t level_count;
+};
+
+// Offsets are from the start of the file. Levels without texture
+// coordinates have an offset of 0 for them.
+struct LevelHeader {
+    std::uint64_t vertex_count;
+    std::uint64_t triangle_count;
+    std::uint64_t vertices_offset;
+    std::uint64_t normals_offset;
+    std::uint64_t x_offset;
+    std::uint64_t y_offset;
+    std::uint64_t z_offset;
+    std::uint64_t triangles_offset;
+    std::uint64_t texture_coordinates_offset;
+    float error;
+    std::array<float, 3> bounding_box_min;
+    std::array<float, 3> bounding_box_max;
+    std::array<float, 3> bounding_sphere_center;
+    float bounding_sphere_radius;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(FileHeader) == 16 && sizeof(LevelHeader) == 120);
+
+static std::uint64_t align_offset(std::uint64_t offset);
+static LevelHeader create_level_header(LevelOfDetail const& level, std::uint64_t& offset);
+
+template <typename T>
+static bool is_valid_section(MappedFile const& file, std::uint64_t offset, std::uint64_t count);
+
+template <typename T>
+static std::span<T const> section(MappedFile const& file, std::uint64_t offset, std::uint64_t count);
+
+bool write_mesh_file(std::filesystem::path const& path, std::vector<LevelOfDetail> const& levels_of_detail) {
+    std::ofstream stream(path, std::ios::binary);
+
+    FileHeader const header = { MAGIC, MESH_FILE_VERSION, static_cast<std::uint32_t>(levels_of_detail.size()) };
+    stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    auto const headers_size = sizeof(FileHeader) + levels_of_detail.size() * sizeof(LevelHeader);
+
+    std::vector<LevelHeader> level_headers;
+    std::uint64_t offset = headers_size;
+    for (auto const& level : levels_of_detail) {
+        level_headers.push_back(create_level_header(level, offset));
+    }
+    stream.write(reinterpret_cast<char const*>(level_headers.data()), level_headers.size() * sizeof(LevelHeader));
+
+    std::uint64_t position = headers_size;
+    auto const write_section = [&](auto const& values, std::uint64_t section_offset) {
+        static constexpr std::array<char, SECTION_ALIGNMENT> padding = {};
+        stream.write(padding.data(), section_offset - position);
+
+        auto const size = values.size_bytes();
+        stream.write(reinterpret_cast<char const*>(values.data()), size);
+        position = section_offset + size;
+        };
+
+    for (std::size_t i = 0; i < levels_of_detail.size(); ++i) {
+        auto const& mesh = levels_of_detail[i].mesh;
+        auto const& level_header = level_headers[i];
+
+        write_section(mesh.vertices(), level_header.vertices_offset);
+        write_section(mesh.normals(), level_header.normals_offset);
+        write_section(mesh.positions().x, level_header.x_offset);
+        write_section(mesh.positions().y, level_header.y_offset);
+        write_section(mesh.positions().z, level_header.z_offset);
+        write_section(mesh.triangles(), level_header.triangles_offset);
+
+        if (level_header.texture_coordinates_offset != 0) {
+            write_section(mesh.texture_coordinates(), level_header.texture_coordinates_offset);
+        }
+    }
+
+    return static_cast<bool>(stream.flush());
+}
+
+std::optional<std::vector<LevelOfDetail>> map_mesh_file(std::shared_ptr<MappedFile const> file) {
+    FileHeader header;
+    if (file->size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (header.magic != MAGIC || header.version != MESH_FILE_VERSION || header.level_count == 0
+        || !is_valid_section<LevelHeader>(*file, sizeof(header), header.level_count)) {
+        return std::nullopt;
+    }
+
+    std::vector<LevelOfDetail> levels;
+    levels.reserve(header.level_count);
+
+    for (auto const& level_header : section<LevelHeader>(*file, sizeof(header), header.level_count)) {
+        auto const vertex_count = level_header.vertex_count;
+        auto const triangle_count = level_header.triangle_count;
+
+        auto const is_valid = vertex_count <= std::uint64_t(std::numeric_limits<VertexIndex>::max()) + 1
+            && is_valid_section<glm::vec3>(*file, level_header.vertices_offset, vertex_count)
+            && is_valid_section<glm::vec3>(*file, level_header.normals_offset, vertex_count)
+            && is_valid_section<float>(*file, level_header.x_offset, vertex_count)
+            && is_valid_section<float>(*file, level_header.y_offset, vertex_count)
+            && is_valid_section<float>(*file, level_header.z_offset, vertex_count)
+            && is_valid_section<Triangle>(*file, level_header.triangles_offset, triangle_count);
+        auto const has_texture_coordinates = level_header.texture_coordinates_offset != 0;
+        if (!is_valid || (has_texture_coordinates
+            && !is_valid_section<glm::vec2>(*file, level_header.texture_coordinates_offset, vertex_count))) {
+            return std::nullopt;
+        }
+
+        auto const texture_coordinate_count = has_texture_coordinates ? vertex_count : 0;
+
+        MeshView const view = {
+            .vertices = section<glm::vec3>(*file, level_header.vertices_offset, vertex_count),
+            .normals = section<glm::vec3>(*file, level_header.normals_offset, vertex_count),
+            .texture_coordinates = section<glm::vec2>(*file, level_header.texture_coordinates_offset, texture_coordinate_count),
+            .positions = {
+                section<float>(*file, level_header.x_offset, vertex_count),
+                section<float>(*file, level_header.y_offset, vertex_count),
+                section<float>(*file, level_header.z_offset, vertex_count),
+            },
+            .triangles = section<Triangle>(*file, level_header.triangles_offset, triangle_count),
+            .bounding_box = {
+                std::bit_cast<glm::vec3>(level_header.bounding_box_min),
+                std::bit_cast<glm::vec3>(level_header.bounding_box_max),
+            },
+            .bounding_sphere = {
+                std::bit_cast<glm::vec3>(level_header.bounding_sphere_center),
+                level_header.bounding_sphere_radius,
+            },
+        };
+
+        levels.push_back({ Mesh(view, file), level_header.error });
+    }
+
+    return levels;
+}
+
+std::uint64_t align_offset(std::uint64_t offset) {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// Sections follow each other in the order they're written, starting at the
+// offset, which is advanced past them.
+LevelHeader create_level_header(LevelOfDetail const& level, std::uint64_t& offset) {
+    auto const& mesh = level.mesh;
+    auto const vertex_count = mesh.vertices().size();
+    auto const triangle_count = mesh.triangles().size();
+
+    auto const next_section = [&](std::uint64_t size) {
+        auto const section_offset = align_offset(offset);
+        offset = section_offset + size;
+        return section_offset;
+        };
+
+    LevelHeader header = {};
+    header.vertex_count = vertex_count;
+    header.triangle_count = triangle_count;
+    header.vertices_offset = next_section(vertex_count * sizeof(glm::vec3));
+    header.normals_offset = next_section(vertex_count * sizeof(glm::vec3));
+    header.x_offset = next_section(vertex_count * sizeof(float));
+    header.y_offset = next_section(vertex_count * sizeof(float));
+    header.z_offset = next_section(vertex_count * sizeof(float));
+    header.triangles_offset = next_section(triangle_count * sizeof(Triangle));
+    if (!mesh.texture_coordinates().empty()) {
+        header.texture_coordinates_offset = next_section(vertex_count * sizeof(glm::vec2));
+    }
+    header.error = level.error;
+    header.bounding_box_min = std::bit_cast<std::array<float, 3>>(mesh.bounding_box().min);
+    header.bounding_box_max = std::bit_cast<std::array<float, 3>>(mesh.bounding_box().max);
+    header.bounding_sphere_center = std::bit_cast<std::array<float, 3>>(mesh.bounding_sphere().center);
+    header.bounding_sphere_radius = mesh.bounding_sphere().radius;
+
+    return header;
+}
+
+// Sections have to lie within the file, at offsets aligned for their type.
+// Counts are checked against the file's size before they're multiplied, so
+// huge ones can't wrap around.
+template <typename T>
+bool is_valid_section(MappedFile const& file, std::uint64_t offset, std::uint64_t count) {
+    return offset % alignof(T) == 0
+        && offset <= file.size()
+        && count <= (file.size() - offset) / sizeof(T);
+}
+
+template <typename T>
+std::span<T const> section(MappedFile const& file, std::uint64_t offset, std::uint64_t count) {
+    return { reinterpret_cast<T const*>(file.data() + offset), static_cast<std::size_t>(count) };
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vcam/core/mapped_file.hh>
+#include <vcam/render/model.hh>
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace vcam {
+
+// Mesh files hold a chain of levels of detail, laid out so that mapping a
+// file gives every attribute in the layout Mesh views: a header, a table of
+// levels with their counts, bounds and errors, then each level's vertices,
+// normals, position streams, triangles and texture coordinates, if it has
+// any, as little-endian arrays aligned to 64 bytes. Files of another version
+// are rejected, not converted.
+constexpr std::uint32_t MESH_FILE_VERSION = 2;
+
+// Returns false if the file couldn't be written.
+bool write_mesh_file(std::filesystem::path const& path, std::vector<LevelOfDetail> const& levels_of_detail);
+
+// Returns the levels of detail of a mesh file, whose meshes view the mapping
+// and keep it alive, or nothing if it isn't a mesh file of this version or
+// is truncated. Nothing is parsed or copied, so this only reads the headers;
+// the attributes are read from the file as they're first accessed. Vertex
+// indices aren't validated, as that would read every triangle, see
+// load_levels_of_detail.
+std::optional<std::vector<LevelOfDetail>> map_mesh_file(std::shared_ptr<MappedFile const> file);
+
+}
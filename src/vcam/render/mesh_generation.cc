@@ -0,0 +1,204 @@
+#include <vcam/render/mesh_generation.hh>
+#include <vcam/render/mesh_optimization.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+namespace vcam {
+
+static Mesh map_sphere_texture_coordinates(std::vector<glm::vec3> const& vertices, std::vector<Triangle> const& triangles);
+
+Mesh generate_sphere_mesh(std::size_t subdivisions, bool texture_coordinates) {
+    auto const mesh = generate_icosahedron_mesh();
+
+    std::vector<glm::vec3> vertices(mesh.vertices().begin(), mesh.vertices().end());
+    std::vector<Triangle> triangles(mesh.triangles().begin(), mesh.triangles().end());
+
+    // Every triangle pushes its own copy of the midpoints it shares with its
+    // neighbours, they're merged by optimize_mesh once subdivision is done.
+    for (auto i = 0; i < subdivisions; ++i) {
+        auto next_vertices = vertices;
+        std::vector<Triangle> next_triangles;
+
+        for (auto& triangle : triangles) {
+            auto const& v0 = vertices[triangle[0]];
+            auto const& v1 = vertices[triangle[1]];
+            auto const& v2 = vertices[triangle[2]];
+
+            auto const mid01 = glm::normalize((v0 + v1) * 0.5f);
+            auto const mid12 = glm::normalize((v1 + v2) * 0.5f);
+            auto const mid20 = glm::normalize((v2 + v0) * 0.5f);
+
+            next_vertices.push_back(mid01);
+            next_vertices.push_back(mid12);
+            next_vertices.push_back(mid20);
+
+            auto const index01 = static_cast<VertexIndex>(next_vertices.size() - 3);
+            auto const index12 = static_cast<VertexIndex>(next_vertices.size() - 2);
+            auto const index20 = static_cast<VertexIndex>(next_vertices.size() - 1);
+
+            next_triangles.push_back({ triangle[0], index01, index20 });
+            next_triangles.push_back({ triangle[1], index12, index01 });
+            next_triangles.push_back({ triangle[2], index20, index12 });
+            next_triangles.push_back({ index01, index12, index20 });
+        }
+
+        vertices = next_vertices;
+        triangles = next_triangles;
+    }
+
+    if (texture_coordinates) {
+        return optimize_mesh(map_sphere_texture_coordinates(vertices, triangles));
+    }
+
+    // Every vertex lies on the unit sphere, so it's its own normal.
+    auto normals = vertices;
+
+    return optimize_mesh(Mesh(std::move(vertices), std::move(normals), std::move(triangles)));
+}
+
+std::vector<LevelOfDetail> generate_sphere_levels_of_detail(std::size_t subdivisions, bool texture_coordinates) {
+    std::vector<LevelOfDetail> levels;
+
+    for (auto level_subdivisions = subdivisions + 1; level_subdivisions-- > 0;) {
+        auto mesh = generate_sphere_mesh(level_subdivisions, texture_coordinates);
+
+        // The sphere bulges furthest out of the face whose plane is
+        // closest to the center.
+        auto error = 0.0f;
+        for (auto const& triangle : mesh.triangles()) {
+            auto const& v0 = mesh.vertices()[triangle[0]];
+            auto const normal = glm::normalize(glm::cross(mesh.vertices()[triangle[1]] - v0, mesh.vertices()[triangle[2]] - v0));
+            error = std::max(error, 1.0f - std::abs(glm::dot(normal, v0)));
+        }
+
+        levels.push_back({ std::move(mesh), error });
+    }
+
+    return levels;
+}
+
+Mesh generate_icosahedron_mesh() {
+    float phi = (1.0f + sqrt(5.0f)) * 0.5f;
+    float a = 1.0f;
+    float b = 1.0f / phi;
+
+    std::vector<glm::vec3> vertices;
+    std::vector<Triangle> triangles;
+
+    vertices.emplace_back(0, b, -a);
+    vertices.emplace_back(b, a, 0);
+    vertices.emplace_back(-b, a, 0);
+    vertices.emplace_back(0, b, a);
+    vertices.emplace_back(0, -b, a);
+    vertices.emplace_back(-a, 0, b);
+    vertices.emplace_back(0, -b, -a);
+    vertices.emplace_back(a, 0, -b);
+    vertices.emplace_back(a, 0, b);
+    vertices.emplace_back(-a, 0, -b);
+    vertices.emplace_back(b, -a, 0);
+    vertices.emplace_back(-b, -a, 0);
+
+    for (auto& vertex : vertices) {
+        auto const normal = glm::normalize(vertex);
+        vertex = normal;
+    }
+
+    triangles.push_back({ 0, 1, 2 });
+    triangles.push_back({ 3, 2, 1 });
+    triangles.push_back({ 3, 4, 5 });
+    triangles.push_back({ 3, 8, 4 });
+    triangles.push_back({ 0, 6, 7 });
+    triangles.push_back({ 0, 9, 6 });
+    triangles.push_back({ 4, 10, 11 });
+    triangles.push_back({ 6, 11, 10 });
+    triangles.push_back({ 2, 5, 9 });
+    triangles.push_back({ 11, 9, 5 });
+    triangles.push_back({ 1, 7, 8 });
+    triangles.push_back({ 10, 8, 7 });
+    triangles.push_back({ 3, 5, 2 });
+    triangles.push_back({ 3, 1, 8 });
+    triangles.push_back({ 0, 2, 9 });
+    triangles.push_back({ 0, 7, 1 });
+    triangles.push_back({ 6, 9, 11 });
+    triangles.push_back({ 6, 10, 7 });
+    triangles.push_back({ 4, 11, 5 });
+    triangles.push_back({ 4, 8, 10 });
+
+    auto normals = vertices;
+
+    return Mesh(std::move(vertices), std::move(normals), std::move(triangles));
+}
+
+// Every triangle gets its own copies of its vertices, as those on the seam
+// where u wraps around need a different u on either side of it, and those
+// on the poles, where every u meets, need one matching each triangle.
+// optimize_mesh merges the copies which turn out the same.
+Mesh map_sphere_texture_coordinates(std::vector<glm::vec3> const& vertices, std::vector<Triangle> const& triangles) {
+    std::vector<glm::vec3> mapped_vertices;
+    std::vector<glm::vec2> texture_coordinates;
+    std::vector<Triangle> mapped_triangles;
+    mapped_vertices.reserve(triangles.size() * 3);
+    texture_coordinates.reserve(triangles.size() * 3);
+    mapped_triangles.reserve(triangles.size());
+
+    // The camera looks down +z, so the sphere's front faces -z, where u is
+    // a half and grows towards +x.
+    auto const calculate_texture_coordinates = [](glm::vec3 const& vertex) {
+        auto const u = std::atan2(vertex.x, -vertex.z) / (2.0f * std::numbers::pi_v<float>) + 0.5f;
+        auto const v = std::acos(std::clamp(vertex.y, -1.0f, 1.0f)) / std::numbers::pi_v<float>;
+        return glm::vec2(u, v);
+        };
+
+    for (auto const& triangle : triangles) {
+        std::array<glm::vec2, 3> triangle_texture_coordinates;
+        std::array<bool, 3> is_pole;
+        auto min_u = 1.0f;
+        auto max_u = 0.0f;
+
+        for (std::size_t i = 0; i < 3; ++i) {
+            auto const& vertex = vertices[triangle[i]];
+            triangle_texture_coordinates[i] = calculate_texture_coordinates(vertex);
+            is_pole[i] = vertex.x * vertex.x + vertex.z * vertex.z < 1e-12f;
+
+            if (!is_pole[i]) {
+                min_u = std::min(min_u, triangle_texture_coordinates[i].x);
+                max_u = std::max(max_u, triangle_texture_coordinates[i].x);
+            }
+        }
+
+        // A triangle spanning more than half the longitudes crosses the
+        // seam, so the vertices whose u started over from 0 continue past 1.
+        if (max_u - min_u > 0.5f) {
+            for (auto& vertex_texture_coordinates : triangle_texture_coordinates) {
+                vertex_texture_coordinates.x += vertex_texture_coordinates.x < 0.5f ? 1.0f : 0.0f;
+            }
+        }
+
+        // A pole has no longitude of its own, it takes the one halfway
+        // between the other two vertices.
+        for (std::size_t i = 0; i < 3; ++i) {
+            if (is_pole[i]) {
+                triangle_texture_coordinates[i].x =
+                    (triangle_texture_coordinates[(i + 1) % 3].x + triangle_texture_coordinates[(i + 2) % 3].x) * 0.5f;
+            }
+        }
+
+        auto const first_index = static_cast<VertexIndex>(mapped_vertices.size());
+        for (std::size_t i = 0; i < 3; ++i) {
+            mapped_vertices.push_back(vertices[triangle[i]]);
+            texture_coordinates.push_back(triangle_texture_coordinates[i]);
+        }
+        mapped_triangles.push_back({ first_index, first_index + 1, first_index + 2 });
+    }
+
+    // Every vertex lies on the unit sphere, so it's its own normal.
+    auto normals = mapped_vertices;
+
+    return Mesh(std::move(mapped_vertices), std::move(normals), std::move(mapped_triangles), std::move(texture_coordinates));
+}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace vcam {
+
+Mesh generate_icosahedron_mesh();
+
+// Unit sphere approximated by an icosahedron subdivided the given number of times.
+// Texture coordinates, when asked for, wrap the texture around the sphere
+// once from west to east, with its top edge at the north pole, so u follows
+// the longitude and v the latitude.
+Mesh generate_sphere_mesh(std::size_t subdivisions, bool texture_coordinates = false);
+
+// Spheres of the given number of subdivisions down to a bare icosahedron,
+// with each level's error being how far its faces sink below the sphere.
+std::vector<LevelOfDetail> generate_sphere_levels_of_detail(std::size_t subdivisions, bool texture_coordinates = false);
+
+}
@@ -0,0 +1,713 @@
+#include <vcam/core/mapped_file.hh>
+#include <vcam/render/mesh_import.hh>
+#include <vcam/render/mesh_optimization.hh>
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vcam {
+
+// Cursor over the text of a file, which counts lines for error messages.
+class TextReader {
+public:
+    explicit TextReader(MappedFile const& file)
+        : m_position(reinterpret_cast<char const*>(file.data())), m_end(m_position + file.size()) { }
+
+    char const* position() const {
+        return m_position;
+    }
+
+    std::size_t line() const {
+        return m_line;
+    }
+
+    bool at_end() const {
+        return m_position == m_end;
+    }
+
+    // Whether nothing but spaces is left on the line.
+    bool at_line_end() {
+        skip_spaces();
+        return m_position == m_end || *m_position == '\n' || *m_position == '\r';
+    }
+
+    void next_line() {
+        auto const* const line_end = std::find(m_position, m_end, '\n');
+        m_position = line_end == m_end ? m_end : line_end + 1;
+        ++m_line;
+    }
+
+    void skip_spaces() {
+        while (m_position != m_end && (*m_position == ' ' || *m_position == '\t')) {
+            ++m_position;
+        }
+    }
+
+    // Skips line breaks too.
+    void skip_whitespace() {
+        while (m_position != m_end && is_whitespace(*m_position)) {
+            m_line += *m_position == '\n';
+            ++m_position;
+        }
+    }
+
+    // Reads up to the next whitespace on the line.
+    std::string_view word() {
+        skip_spaces();
+
+        auto const* const start = m_position;
+        while (m_position != m_end && !is_whitespace(*m_position)) {
+            ++m_position;
+        }
+
+        return { start, static_cast<std::size_t>(m_position - start) };
+    }
+
+    template <typename T>
+    bool number(T& value) {
+        skip_spaces();
+
+        auto const [end, error] = std::from_chars(m_position, m_end, value);
+        if (error != std::errc()) {
+            return false;
+        }
+
+        m_position = end;
+        return true;
+    }
+
+private:
+    char const* m_position;
+    char const* m_end;
+    std::size_t m_line = 1;
+
+    static bool is_whitespace(char character) {
+        return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+    }
+};
+
+enum class PlyType {
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64
+};
+
+struct PlyProperty {
+    std::string name;
+    PlyType type;
+
+    // Lists are a count of the count type followed by that many values of
+    // the property's type.
+    bool is_list;
+    PlyType count_type;
+};
+
+struct PlyElement {
+    std::string name;
+    std::uint64_t count;
+    std::vector<PlyProperty> properties;
+};
+
+// Values of ASCII PLY files, separated by whitespace.
+class PlyTextReader {
+public:
+    explicit PlyTextReader(TextReader& text) : m_text(text) { }
+
+    // Any type's text reads as a double.
+    bool read(PlyType, double& value) {
+        m_text.skip_whitespace();
+        return m_text.number(value);
+    }
+
+private:
+    TextReader& m_text;
+};
+
+// Values of binary PLY files, packed one after another.
+class PlyBinaryReader {
+public:
+    explicit PlyBinaryReader(char const* start, char const* end, std::endian endianness)
+        : m_position(start), m_end(end), m_swap_bytes(endianness != std::endian::native) { }
+
+    bool read(PlyType type, double& value);
+
+private:
+    char const* m_position;
+    char const* m_end;
+    bool m_swap_bytes;
+
+    template <typename T>
+    static double load(std::array<char, 8> const& bytes);
+};
+
+// Vertices and triangles read from a PLY file.
+struct PlyMesh {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texture_coordinates;
+    std::vector<Triangle> triangles;
+};
+
+// Indices of an OBJ vertex's position, texture coordinates and normal.
+using ObjVertexKey = std::array<std::uint32_t, 3>;
+
+struct ObjVertexKeyHash {
+    std::size_t operator()(ObjVertexKey const& key) const {
+        std::size_t hash = 0;
+        for (auto const value : key) {
+            hash ^= std::hash<std::uint32_t>{}(value) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+static constexpr VertexIndex MAX_VERTEX_COUNT = std::numeric_limits<VertexIndex>::max();
+
+static std::nullopt_t import_error(std::filesystem::path const& path, char const* reason);
+static std::nullopt_t import_error(std::filesystem::path const& path, char const* reason, std::size_t line);
+static bool parse_obj_index(std::string_view token, std::size_t count, std::uint32_t& index);
+static bool parse_ply_type(std::string_view name, PlyType& type);
+static std::size_t ply_type_size(PlyType type);
+
+template <typename Reader>
+static char const* read_ply_elements(Reader& reader, std::vector<PlyElement> const& elements, PlyMesh& mesh);
+
+static void add_fan(std::vector<VertexIndex> const& polygon, std::vector<Triangle>& triangles);
+static bool has_valid_indices(std::vector<Triangle> const& triangles, std::size_t vertex_count);
+static std::vector<glm::vec3> calculate_vertex_normals(std::vector<glm::vec3> const& vertices, std::vector<Triangle> const& triangles);
+
+// Vertices are unique triples of position, texture coordinate and normal
+// indices, so faces sharing a position but not the rest get vertices of
+// their own. Missing indices are NO_INDEX.
+std::optional<Mesh> import_obj(std::filesystem::path const& path) {
+    constexpr auto NO_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+    auto const file = MappedFile::open(path);
+    if (file == nullptr) {
+        return import_error(path, "can't open the file");
+    }
+
+    TextReader reader(*file);
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> file_texture_coordinates;
+    std::vector<glm::vec3> file_normals;
+
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texture_coordinates;
+    std::vector<Triangle> triangles;
+    std::vector<ObjVertexKey> vertex_keys;
+    std::unordered_map<ObjVertexKey, VertexIndex, ObjVertexKeyHash> vertex_indices;
+    std::vector<VertexIndex> polygon;
+    auto has_texture_coordinates = false;
+    auto has_missing_normals = false;
+
+    for (; !reader.at_end(); reader.next_line()) {
+        auto const keyword = reader.word();
+
+        if (keyword == "v" || keyword == "vn") {
+            glm::vec3 value;
+            if (!reader.number(value.x) || !reader.number(value.y) || !reader.number(value.z)) {
+                return import_error(path, "invalid vertex", reader.line());
+            }
+            (keyword == "v" ? positions : file_normals).emplace_back(value.x, value.y, -value.z);
+            continue;
+        }
+
+        // Texture coordinates count v from the bottom of the image.
+        if (keyword == "vt") {
+            glm::vec2 value;
+            if (!reader.number(value.x) || !reader.number(value.y)) {
+                return import_error(path, "invalid texture coordinates", reader.line());
+            }
+            file_texture_coordinates.emplace_back(value.x, 1.0f - value.y);
+            continue;
+        }
+
+        if (keyword != "f") {
+            continue;
+        }
+
+        polygon.clear();
+        while (!reader.at_line_end()) {
+            // Vertices are position/texture coordinate/normal, with all but
+            // the position optional.
+            auto const token = reader.word();
+            auto const first_slash = token.find('/');
+            auto const second_slash = first_slash == std::string_view::npos ? first_slash : token.find('/', first_slash + 1);
+
+            auto const texture_coordinates_token = first_slash == std::string_view::npos
+                ? std::string_view()
+                : token.substr(first_slash + 1, second_slash - first_slash - 1);
+
+            std::uint32_t position = 0;
+            auto texture_coordinate = NO_INDEX;
+            auto normal = NO_INDEX;
+            if (!parse_obj_index(token.substr(0, first_slash), positions.size(), position)
+                || (!texture_coordinates_token.empty()
+                    && !parse_obj_index(texture_coordinates_token, file_texture_coordinates.size(), texture_coordinate))
+                || (second_slash != std::string_view::npos
+                    && !parse_obj_index(token.substr(second_slash + 1), file_normals.size(), normal))) {
+                return import_error(path, "invalid face", reader.line());
+            }
+
+            ObjVertexKey const key = { position, texture_coordinate, normal };
+            auto const [it, inserted] = vertex_indices.try_emplace(key, static_cast<VertexIndex>(vertices.size()));
+            if (inserted) {
+                if (vertices.size() == MAX_VERTEX_COUNT) {
+                    return import_error(path, "too many vertices", reader.line());
+                }
+
+                vertices.push_back(positions[position]);
+                normals.push_back(normal == NO_INDEX ? glm::vec3(0.0f) : file_normals[normal]);
+                texture_coordinates.push_back(
+                    texture_coordinate == NO_INDEX ? glm::vec2(0.0f) : file_texture_coordinates[texture_coordinate]
+                );
+                vertex_keys.push_back(key);
+                has_texture_coordinates |= texture_coordinate != NO_INDEX;
+                has_missing_normals |= normal == NO_INDEX;
+            }
+            polygon.push_back(it->second);
+        }
+
+        if (polygon.size() < 3) {
+            return import_error(path, "face with fewer than 3 vertices", reader.line());
+        }
+        add_fan(polygon, triangles);
+    }
+
+    if (triangles.empty()) {
+        return import_error(path, "no faces");
+    }
+
+    // Normals are calculated around positions rather than vertices, so that
+    // vertices split along a seam of texture coordinates get the same one.
+    if (has_missing_normals) {
+        std::vector<Triangle> position_triangles;
+        position_triangles.reserve(triangles.size());
+        for (auto const& triangle : triangles) {
+            position_triangles.push_back({ vertex_keys[triangle[0]][0], vertex_keys[triangle[1]][0], vertex_keys[triangle[2]][0] });
+        }
+
+        auto const calculated_normals = calculate_vertex_normals(positions, position_triangles);
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            if (vertex_keys[i][2] == NO_INDEX) {
+                normals[i] = calculated_normals[vertex_keys[i][0]];
+            }
+        }
+    }
+
+    if (!has_texture_coordinates) {
+        texture_coordinates.clear();
+    }
+
+    return optimize_mesh(Mesh(std::move(vertices), std::move(normals), std::move(triangles), std::move(texture_coordinates)));
+}
+
+std::optional<Mesh> import_ply(std::filesystem::path const& path) {
+    auto const file = MappedFile::open(path);
+    if (file == nullptr) {
+        return import_error(path, "can't open the file");
+    }
+
+    TextReader reader(*file);
+    if (reader.word() != "ply") {
+        return import_error(path, "not a PLY file");
+    }
+
+    std::string_view format;
+    std::vector<PlyElement> elements;
+
+    while (true) {
+        reader.next_line();
+        if (reader.at_end()) {
+            return import_error(path, "missing end_header");
+        }
+
+        auto const keyword = reader.word();
+
+        if (keyword == "end_header") {
+            reader.next_line();
+            break;
+        }
+
+        if (keyword == "format") {
+            format = reader.word();
+        } else if (keyword == "element") {
+            auto& element = elements.emplace_back();
+            element.name = reader.word();
+            if (!reader.number(element.count)) {
+                return import_error(path, "invalid element", reader.line());
+            }
+        } else if (keyword == "property") {
+            if (elements.empty()) {
+                return import_error(path, "property outside of an element", reader.line());
+            }
+
+            PlyProperty property = {};
+            auto type = reader.word();
+            if (type == "list") {
+                property.is_list = true;
+                if (!parse_ply_type(reader.word(), property.count_type)) {
+                    return import_error(path, "invalid property type", reader.line());
+                }
+                type = reader.word();
+            }
+            if (!parse_ply_type(type, property.type)) {
+                return import_error(path, "invalid property type", reader.line());
+            }
+            property.name = reader.word();
+
+            elements.back().properties.push_back(std::move(property));
+        } else if (keyword != "comment" && keyword != "obj_info" && !keyword.empty()) {
+            return import_error(path, "invalid header", reader.line());
+        }
+    }
+
+    PlyMesh mesh;
+    char const* error = nullptr;
+
+    if (format == "ascii") {
+        PlyTextReader text_reader(reader);
+        error = read_ply_elements(text_reader, elements, mesh);
+    } else if (format == "binary_little_endian" || format == "binary_big_endian") {
+        auto const endianness = format == "binary_little_endian" ? std::endian::little : std::endian::big;
+        auto const* const end = reinterpret_cast<char const*>(file->data()) + file->size();
+        PlyBinaryReader binary_reader(reader.position(), end, endianness);
+        error = read_ply_elements(binary_reader, elements, mesh);
+    } else {
+        error = "unknown format";
+    }
+
+    if (error != nullptr) {
+        return import_error(path, error);
+    }
+
+    if (mesh.triangles.empty()) {
+        return import_error(path, "no faces");
+    }
+
+    if (!has_valid_indices(mesh.triangles, mesh.vertices.size())) {
+        return import_error(path, "invalid vertex index");
+    }
+
+    if (mesh.normals.empty()) {
+        mesh.normals = calculate_vertex_normals(mesh.vertices, mesh.triangles);
+    }
+
+    return optimize_mesh(Mesh(
+        std::move(mesh.vertices),
+        std::move(mesh.normals),
+        std::move(mesh.triangles),
+        std::move(mesh.texture_coordinates)
+    ));
+}
+
+bool PlyBinaryReader::read(PlyType type, double& value) {
+    auto const size = ply_type_size(type);
+    if (static_cast<std::size_t>(m_end - m_position) < size) {
+        return false;
+    }
+
+    std::array<char, 8> bytes;
+    std::memcpy(bytes.data(), m_position, size);
+    m_position += size;
+
+    if (m_swap_bytes) {
+        std::reverse(bytes.begin(), bytes.begin() + size);
+    }
+
+    switch (type) {
+    case PlyType::INT8:
+        value = load<std::int8_t>(bytes);
+        return true;
+
+    case PlyType::UINT8:
+        value = load<std::uint8_t>(bytes);
+        return true;
+
+    case PlyType::INT16:
+        value = load<std::int16_t>(bytes);
+        return true;
+
+    case PlyType::UINT16:
+        value = load<std::uint16_t>(bytes);
+        return true;
+
+    case PlyType::INT32:
+        value = load<std::int32_t>(bytes);
+        return true;
+
+    case PlyType::UINT32:
+        value = load<std::uint32_t>(bytes);
+        return true;
+
+    case PlyType::FLOAT32:
+        value = load<float>(bytes);
+        return true;
+
+    case PlyType::FLOAT64:
+        value = load<double>(bytes);
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+double PlyBinaryReader::load(std::array<char, 8> const& bytes) {
+    T value;
+    std::memcpy(&value, bytes.data(), sizeof(value));
+    return static_cast<double>(value);
+}
+
+std::nullopt_t import_error(std::filesystem::path const& path, char const* reason) {
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to import %s: %s", path.string().c_str(), reason);
+    return std::nullopt;
+}
+
+std::nullopt_t import_error(std::filesystem::path const& path, char const* reason, std::size_t line) {
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to import %s: %s on line %zu", path.string().c_str(), reason, line);
+    return std::nullopt;
+}
+
+// Indices count from 1, or from -1 backwards from the last element read so
+// far.
+bool parse_obj_index(std::string_view token, std::size_t count, std::uint32_t& index) {
+    long long value = 0;
+    auto const [end, error] = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (error != std::errc() || end != token.data() + token.size()) {
+        return false;
+    }
+
+    auto const resolved = value < 0 ? static_cast<long long>(count) + value : value - 1;
+    if (resolved < 0 || resolved >= static_cast<long long>(count)) {
+        return false;
+    }
+
+    index = static_cast<std::uint32_t>(resolved);
+    return true;
+}
+
+bool parse_ply_type(std::string_view name, PlyType& type) {
+    constexpr std::array<std::pair<std::string_view, PlyType>, 16> TYPES = { {
+        { "char", PlyType::INT8 },
+        { "int8", PlyType::INT8 },
+        { "uchar", PlyType::UINT8 },
+        { "uint8", PlyType::UINT8 },
+        { "short", PlyType::INT16 },
+        { "int16", PlyType::INT16 },
+        { "ushort", PlyType::UINT16 },
+        { "uint16", PlyType::UINT16 },
+        { "int", PlyType::INT32 },
+        { "int32", PlyType::INT32 },
+        { "uint", PlyType::UINT32 },
+        { "uint32", PlyType::UINT32 },
+        { "float", PlyType::FLOAT32 },
+        { "float32", PlyType::FLOAT32 },
+        { "double", PlyType::FLOAT64 },
+        { "float64", PlyType::FLOAT64 },
+    } };
+
+    for (auto const& [type_name, type_value] : TYPES) {
+        if (name == type_name) {
+            type = type_value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::size_t ply_type_size(PlyType type) {
+    switch (type) {
+    case PlyType::INT8:
+    case PlyType::UINT8:
+        return 1;
+
+    case PlyType::INT16:
+    case PlyType::UINT16:
+        return 2;
+
+    case PlyType::INT32:
+    case PlyType::UINT32:
+    case PlyType::FLOAT32:
+        return 4;
+
+    case PlyType::FLOAT64:
+        return 8;
+    }
+
+    return 0;
+}
+
+// Reads every element, keeping the vertices and faces. Returns why the data
+// is malformed, or null. Normals and texture coordinates are only kept if
+// vertices have all of their coordinates. Texture coordinates go by several
+// names, which share slots, and count v from the bottom of the image.
+template <typename Reader>
+char const* read_ply_elements(Reader& reader, std::vector<PlyElement> const& elements, PlyMesh& mesh) {
+    constexpr std::size_t SLOT_COUNT = 8;
+    constexpr std::array<std::pair<std::string_view, std::size_t>, 12> VERTEX_PROPERTIES = { {
+        { "x", 0 },
+        { "y", 1 },
+        { "z", 2 },
+        { "nx", 3 },
+        { "ny", 4 },
+        { "nz", 5 },
+        { "u", 6 },
+        { "v", 7 },
+        { "s", 6 },
+        { "t", 7 },
+        { "texture_u", 6 },
+        { "texture_v", 7 },
+    } };
+    constexpr std::size_t NOT_KEPT = SLOT_COUNT;
+
+    std::vector<VertexIndex> polygon;
+
+    for (auto const& element : elements) {
+        auto const is_vertex = element.name == "vertex";
+        auto const is_face = element.name == "face";
+
+        // Slots of the values of vertex properties, see VERTEX_PROPERTIES.
+        std::vector<std::size_t> slots;
+        std::array<bool, SLOT_COUNT> has_slot = {};
+        for (auto const& property : element.properties) {
+            auto const vertex_property = std::find_if(VERTEX_PROPERTIES.begin(), VERTEX_PROPERTIES.end(), [&](auto const& entry) {
+                return entry.first == property.name;
+                });
+            auto const slot = vertex_property == VERTEX_PROPERTIES.end() ? NOT_KEPT : vertex_property->second;
+            if (is_vertex && !property.is_list && slot != NOT_KEPT) {
+                slots.push_back(slot);
+                has_slot[slot] = true;
+            } else {
+                slots.push_back(NOT_KEPT);
+            }
+        }
+
+        auto const has_normals = has_slot[3] && has_slot[4] && has_slot[5];
+        auto const has_texture_coordinates = has_slot[6] && has_slot[7];
+        if (is_vertex) {
+            if (!has_slot[0] || !has_slot[1] || !has_slot[2]) {
+                return "vertices without positions";
+            }
+            if (element.count > MAX_VERTEX_COUNT) {
+                return "too many vertices";
+            }
+        }
+
+        for (std::uint64_t i = 0; i < element.count; ++i) {
+            std::array<float, SLOT_COUNT> values = {};
+
+            for (std::size_t j = 0; j < element.properties.size(); ++j) {
+                auto const& property = element.properties[j];
+                double value = 0.0;
+
+                if (!property.is_list) {
+                    if (!reader.read(property.type, value)) {
+                        return "truncated data";
+                    }
+                    if (slots[j] != NOT_KEPT) {
+                        values[slots[j]] = static_cast<float>(value);
+                    }
+                    continue;
+                }
+
+                double count = 0.0;
+                if (!reader.read(property.count_type, count) || count < 0.0) {
+                    return "truncated data";
+                }
+
+                auto const is_polygon = is_face && (property.name == "vertex_indices" || property.name == "vertex_index");
+                polygon.clear();
+
+                for (std::uint64_t k = 0; k < static_cast<std::uint64_t>(count); ++k) {
+                    if (!reader.read(property.type, value)) {
+                        return "truncated data";
+                    }
+                    if (is_polygon) {
+                        if (value < 0.0 || value >= MAX_VERTEX_COUNT) {
+                            return "invalid vertex index";
+                        }
+                        polygon.push_back(static_cast<VertexIndex>(value));
+                    }
+                }
+
+                if (is_polygon) {
+                    if (polygon.size() < 3) {
+                        return "face with fewer than 3 vertices";
+                    }
+                    add_fan(polygon, mesh.triangles);
+                }
+            }
+
+            if (is_vertex) {
+                mesh.vertices.emplace_back(values[0], values[1], -values[2]);
+                if (has_normals) {
+                    mesh.normals.emplace_back(values[3], values[4], -values[5]);
+                }
+                if (has_texture_coordinates) {
+                    mesh.texture_coordinates.emplace_back(values[6], 1.0f - values[7]);
+                }
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void add_fan(std::vector<VertexIndex> const& polygon, std::vector<Triangle>& triangles) {
+    for (std::size_t i = 2; i < polygon.size(); ++i) {
+        triangles.push_back({ polygon[0], polygon[i - 1], polygon[i] });
+    }
+}
+
+bool has_valid_indices(std::vector<Triangle> const& triangles, std::size_t vertex_count) {
+    return std::all_of(triangles.begin(), triangles.end(), [&](Triangle const& triangle) {
+        return triangle[0] < vertex_count && triangle[1] < vertex_count && triangle[2] < vertex_count;
+        });
+}
+
+// Cross products are twice the triangles' areas, so summing them weights
+// every face's normal by its area. Front faces wind clockwise around their
+// normal in the left-handed model space. Vertices of degenerate faces only
+// get an arbitrary normal.
+std::vector<glm::vec3> calculate_vertex_normals(std::vector<glm::vec3> const& vertices, std::vector<Triangle> const& triangles) {
+    std::vector<glm::vec3> normals(vertices.size(), glm::vec3(0.0f));
+
+    for (auto const& triangle : triangles) {
+        auto const& v0 = vertices[triangle[0]];
+        auto const normal = glm::cross(vertices[triangle[2]] - v0, vertices[triangle[1]] - v0);
+        for (auto const index : triangle) {
+            normals[index] += normal;
+        }
+    }
+
+    for (auto& normal : normals) {
+        auto const length = glm::length(normal);
+        normal = length > 0.0f ? normal / length : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+
+    return normals;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <filesystem>
+#include <optional>
+
+namespace vcam {
+
+// Importers return optimized meshes (see optimize_mesh), or nothing if the
+// file can't be read or is malformed, logging why. Files are taken to be
+// right-handed with counterclockwise front faces, as they usually are, and
+// are mirrored along z into left-handed model space, which keeps their front
+// faces facing out. Polygons are split into fans of triangles, and vertices
+// without normals get the area-weighted average of the normals of the faces
+// around them.
+
+// Reads the vertex positions, texture coordinates, normals and faces of a
+// Wavefront OBJ file, ignoring everything else, materials included. Vertices
+// without texture coordinates get (0, 0) if others have them.
+std::optional<Mesh> import_obj(std::filesystem::path const& path);
+
+// Reads the x, y, z, nx, ny and nz properties of the vertex element, along
+// with its texture coordinates as u and v, s and t or texture_u and
+// texture_v, and the vertex_indices list of the face element of an ASCII or
+// binary PLY file, ignoring everything else.
+std::optional<Mesh> import_ply(std::filesystem::path const& path);
+
+}
@@ -0,0 +1,127 @@
+#include <vcam/core/mapped_file.hh>
+#include <vcam/render/mesh_file.hh>
+#include <vcam/render/mesh_import.hh>
+#include <vcam/render/mesh_loader.hh>
+#include <vcam/render/mesh_simplification.hh>
+
+#include <SDL3/SDL.h>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <string>
+#include <utility>
+
+namespace vcam {
+
+static bool has_valid_indices(std::vector<LevelOfDetail> const& levels_of_detail);
+
+LoadedLevelsOfDetail load_levels_of_detail(std::filesystem::path const& path) {
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) {
+        return static_cast<char>(std::tolower(character));
+        });
+
+    if (extension == MESH_FILE_EXTENSION) {
+        auto file = MappedFile::open(path);
+        if (file == nullptr) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to open %s", path.string().c_str());
+            return std::nullopt;
+        }
+
+        file->prefetch();
+
+        auto levels = map_mesh_file(std::move(file));
+        if (!levels || !has_valid_indices(*levels)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s isn't a valid version %u mesh file", path.string().c_str(), MESH_FILE_VERSION);
+            return std::nullopt;
+        }
+        return levels;
+    }
+
+    std::optional<Mesh> mesh;
+    if (extension == ".obj") {
+        mesh = import_obj(path);
+    } else if (extension == ".ply") {
+        mesh = import_ply(path);
+    } else {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Unknown mesh format: %s", path.string().c_str());
+    }
+
+    if (!mesh) {
+        return std::nullopt;
+    }
+
+    return generate_levels_of_detail(*mesh);
+}
+
+// Prefetching reads the triangles in anyway, so checking them costs little
+// on top, and keeps corrupt files from making the renderer read out of
+// bounds.
+bool has_valid_indices(std::vector<LevelOfDetail> const& levels_of_detail) {
+    for (auto const& level : levels_of_detail) {
+        auto const vertex_count = level.mesh.vertices().size();
+        for (auto const& triangle : level.mesh.triangles()) {
+            if (triangle[0] >= vertex_count || triangle[1] >= vertex_count || triangle[2] >= vertex_count) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+MeshLoader::MeshLoader() : m_thread([this] { run(); }) { }
+
+MeshLoader::~MeshLoader() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_job_available.notify_one();
+
+    m_thread.join();
+}
+
+std::future<LoadedLevelsOfDetail> MeshLoader::load(std::filesystem::path path) {
+    std::future<LoadedLevelsOfDetail> result;
+    {
+        std::lock_guard lock(m_mutex);
+        auto& job = m_jobs.emplace_back(Job{ std::move(path), {} });
+        result = job.result.get_future();
+    }
+    m_job_available.notify_one();
+
+    return result;
+}
+
+// Exceptions would end the program on this thread, and large files can run
+// out of memory while they're imported, so failures are logged and loading
+// continues with the next file.
+void MeshLoader::run() {
+    std::unique_lock lock(m_mutex);
+
+    while (true) {
+        m_job_available.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+        if (m_stopping) {
+            return;
+        }
+
+        auto job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+
+        lock.unlock();
+
+        LoadedLevelsOfDetail levels_of_detail;
+        try {
+            levels_of_detail = load_levels_of_detail(job.path);
+        } catch (std::exception const& exception) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to load a mesh: %s", exception.what());
+        }
+        job.result.set_value(std::move(levels_of_detail));
+
+        lock.lock();
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace vcam {
+
+// Extension of mesh files, see write_mesh_file.
+constexpr char const* MESH_FILE_EXTENSION = ".vcmesh";
+
+using LoadedLevelsOfDetail = std::optional<std::vector<LevelOfDetail>>;
+
+// Loads the levels of detail of a file, telling formats apart by extension.
+// Mesh files are mapped, then read in ahead of their first access while
+// their vertex indices are validated. OBJ and PLY files are imported, with
+// their levels generated by generate_levels_of_detail. Returns nothing if
+// loading fails, logging why.
+LoadedLevelsOfDetail load_levels_of_detail(std::filesystem::path const& path);
+
+// Loads files with load_levels_of_detail on a thread of its own, one at a
+// time in the order they were queued, so that threads queuing them never
+// wait for the disk or for importing.
+class MeshLoader {
+public:
+    MeshLoader();
+
+    // Waits for the file being loaded, dropping the ones still queued.
+    ~MeshLoader();
+
+    MeshLoader(MeshLoader const& other) = delete;
+    MeshLoader& operator=(MeshLoader const& other) = delete;
+
+    std::future<LoadedLevelsOfDetail> load(std::filesystem::path path);
+
+private:
+    struct Job {
+        std::filesystem::path path;
+        std::promise<LoadedLevelsOfDetail> result;
+    };
+
+    std::mutex m_mutex;
+    std::condition_variable m_job_available;
+    std::deque<Job> m_jobs;
+    bool m_stopping = false;
+
+    // Started last, once everything it uses is constructed.
+    std::thread m_thread;
+
+    void run();
+};
+
+}
@@ -0,0 +1,255 @@
+#include <vcam/render/mesh_optimization.hh>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+
+namespace vcam {
+
+// Bit patterns of a vertex's position, normal and texture coordinates.
+using WeldKey = std::array<std::uint32_t, 8>;
+
+struct WeldKeyHash {
+    std::size_t operator()(WeldKey const& key) const {
+        std::size_t hash = 0;
+        for (auto const value : key) {
+            hash ^= std::hash<std::uint32_t>{}(value) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
+static WeldKey calculate_weld_key(glm::vec3 const& position, glm::vec3 const& normal, glm::vec2 const& texture_coordinates) {
+    return {
+        std::bit_cast<std::uint32_t>(position.x),
+        std::bit_cast<std::uint32_t>(position.y),
+        std::bit_cast<std::uint32_t>(position.z),
+        std::bit_cast<std::uint32_t>(normal.x),
+        std::bit_cast<std::uint32_t>(normal.y),
+        std::bit_cast<std::uint32_t>(normal.z),
+        std::bit_cast<std::uint32_t>(texture_coordinates.x),
+        std::bit_cast<std::uint32_t>(texture_coordinates.y)
+    };
+}
+
+Mesh weld_vertices(Mesh const& mesh) {
+    auto const vertices = mesh.vertices();
+    auto const normals = mesh.normals();
+    auto const texture_coordinates = mesh.texture_coordinates();
+    auto const has_texture_coordinates = !texture_coordinates.empty();
+
+    std::vector<glm::vec3> welded_vertices;
+    std::vector<glm::vec3> welded_normals;
+    std::vector<glm::vec2> welded_texture_coordinates;
+    std::vector<VertexIndex> remap(vertices.size());
+
+    std::unordered_map<WeldKey, VertexIndex, WeldKeyHash> indices;
+    indices.reserve(vertices.size());
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        auto const next_index = static_cast<VertexIndex>(welded_vertices.size());
+        auto const vertex_texture_coordinates = has_texture_coordinates ? texture_coordinates[i] : glm::vec2(0.0f);
+        auto const key = calculate_weld_key(vertices[i], normals[i], vertex_texture_coordinates);
+        auto const [it, inserted] = indices.try_emplace(key, next_index);
+        if (inserted) {
+            welded_vertices.push_back(vertices[i]);
+            welded_normals.push_back(normals[i]);
+            if (has_texture_coordinates) {
+                welded_texture_coordinates.push_back(vertex_texture_coordinates);
+            }
+        }
+        remap[i] = it->second;
+    }
+
+    std::vector<Triangle> triangles(mesh.triangles().begin(), mesh.triangles().end());
+    for (auto& triangle : triangles) {
+        for (auto& index : triangle) {
+            index = remap[index];
+        }
+    }
+
+    return Mesh(std::move(welded_vertices), std::move(welded_normals), std::move(triangles), std::move(welded_texture_coordinates));
+}
+
+// Vertex adjacency in compressed form: the triangles using vertex v are
+// triangles[offsets[v]] ... triangles[offsets[v + 1] - 1].
+struct VertexAdjacency {
+    std::vector<std::size_t> offsets;
+    std::vector<std::size_t> triangles;
+};
+
+static VertexAdjacency calculate_vertex_adjacency(std::vector<Triangle> const& triangles, std::size_t vertex_count) {
+    VertexAdjacency adjacency;
+    adjacency.offsets.assign(vertex_count + 1, 0);
+
+    for (auto const& triangle : triangles) {
+        for (auto const index : triangle) {
+            ++adjacency.offsets[index + 1];
+        }
+    }
+
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        adjacency.offsets[v + 1] += adjacency.offsets[v];
+    }
+
+    auto cursors = adjacency.offsets;
+    adjacency.triangles.resize(triangles.size() * 3);
+    for (std::size_t t = 0; t < triangles.size(); ++t) {
+        for (auto const index : triangles[t]) {
+            adjacency.triangles[cursors[index]++] = t;
+        }
+    }
+
+    return adjacency;
+}
+
+void optimize_vertex_cache(std::vector<Triangle>& triangles, std::size_t vertex_count, std::size_t cache_size) {
+    constexpr auto NO_VERTEX = std::numeric_limits<std::size_t>::max();
+
+    auto const adjacency = calculate_vertex_adjacency(triangles, vertex_count);
+
+    // Triangles not yet emitted which use each vertex.
+    std::vector<std::size_t> live_triangles(vertex_count);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        live_triangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+    }
+
+    // Time each vertex last entered the cache; a vertex is in the cache while
+    // fewer than cache_size vertices entered it since.
+    std::vector<std::size_t> cache_times(vertex_count, 0);
+    auto time = cache_size + 1;
+
+    std::vector<bool> emitted(triangles.size(), false);
+    std::vector<std::size_t> dead_end_stack;
+    std::vector<std::size_t> candidates;
+    std::size_t cursor = 0;
+
+    std::vector<Triangle> output;
+    output.reserve(triangles.size());
+
+    auto fanning_vertex = vertex_count > 0 ? std::size_t(0) : NO_VERTEX;
+    while (fanning_vertex != NO_VERTEX) {
+        candidates.clear();
+
+        for (auto a = adjacency.offsets[fanning_vertex]; a < adjacency.offsets[fanning_vertex + 1]; ++a) {
+            auto const t = adjacency.triangles[a];
+            if (emitted[t]) {
+                continue;
+            }
+
+            for (auto const index : triangles[t]) {
+                dead_end_stack.push_back(index);
+                candidates.push_back(index);
+                --live_triangles[index];
+
+                if (time - cache_times[index] > cache_size) {
+                    cache_times[index] = time;
+                    ++time;
+                }
+            }
+
+            output.push_back(triangles[t]);
+            emitted[t] = true;
+        }
+
+        // Prefer the candidate which entered the cache the longest ago but
+        // will still be in it once its remaining triangles are emitted.
+        fanning_vertex = NO_VERTEX;
+        std::ptrdiff_t best_priority = -1;
+        for (auto const v : candidates) {
+            if (live_triangles[v] == 0) {
+                continue;
+            }
+
+            std::ptrdiff_t priority = 0;
+            if (time - cache_times[v] + 2 * live_triangles[v] <= cache_size) {
+                priority = static_cast<std::ptrdiff_t>(time - cache_times[v]);
+            }
+
+            if (priority > best_priority) {
+                best_priority = priority;
+                fanning_vertex = v;
+            }
+        }
+
+        if (fanning_vertex != NO_VERTEX) {
+            continue;
+        }
+
+        // Dead end, fall back to a recently used vertex or the next vertex
+        // in input order which still has triangles left.
+        while (!dead_end_stack.empty() && fanning_vertex == NO_VERTEX) {
+            auto const v = dead_end_stack.back();
+            dead_end_stack.pop_back();
+            if (live_triangles[v] > 0) {
+                fanning_vertex = v;
+            }
+        }
+
+        for (; cursor < vertex_count && fanning_vertex == NO_VERTEX; ++cursor) {
+            if (live_triangles[cursor] > 0) {
+                fanning_vertex = cursor;
+            }
+        }
+    }
+
+    triangles = std::move(output);
+}
+
+Mesh optimize_vertex_fetch(Mesh const& mesh) {
+    constexpr auto UNASSIGNED = std::numeric_limits<VertexIndex>::max();
+
+    auto const vertices = mesh.vertices();
+    auto const normals = mesh.normals();
+    auto const texture_coordinates = mesh.texture_coordinates();
+
+    std::vector<VertexIndex> remap(vertices.size(), UNASSIGNED);
+    std::vector<glm::vec3> ordered_vertices;
+    std::vector<glm::vec3> ordered_normals;
+    std::vector<glm::vec2> ordered_texture_coordinates;
+    ordered_vertices.reserve(vertices.size());
+    ordered_normals.reserve(vertices.size());
+    ordered_texture_coordinates.reserve(texture_coordinates.size());
+
+    std::vector<Triangle> triangles(mesh.triangles().begin(), mesh.triangles().end());
+    for (auto& triangle : triangles) {
+        for (auto& index : triangle) {
+            if (remap[index] == UNASSIGNED) {
+                remap[index] = static_cast<VertexIndex>(ordered_vertices.size());
+                ordered_vertices.push_back(vertices[index]);
+                ordered_normals.push_back(normals[index]);
+                if (!texture_coordinates.empty()) {
+                    ordered_texture_coordinates.push_back(texture_coordinates[index]);
+                }
+            }
+            index = remap[index];
+        }
+    }
+
+    return Mesh(
+        std::move(ordered_vertices),
+        std::move(ordered_normals),
+        std::move(triangles),
+        std::move(ordered_texture_coordinates)
+    );
+}
+
+Mesh optimize_mesh(Mesh const& mesh) {
+    auto const welded = weld_vertices(mesh);
+
+    std::vector<Triangle> triangles(welded.triangles().begin(), welded.triangles().end());
+    optimize_vertex_cache(triangles, welded.vertices().size());
+
+    return optimize_vertex_fetch(Mesh(
+        std::vector<glm::vec3>(welded.vertices().begin(), welded.vertices().end()),
+        std::vector<glm::vec3>(welded.normals().begin(), welded.normals().end()),
+        std::move(triangles),
+        std::vector<glm::vec2>(welded.texture_coordinates().begin(), welded.texture_coordinates().end())
+    ));
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace vcam {
+
+// Merges vertices whose positions, normals and texture coordinates are
+// bitwise identical.
+Mesh weld_vertices(Mesh const& mesh);
+
+// Reorders triangles so that consecutive ones share vertices, using Tipsify
+// (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced
+// Overdraw", 2007) tuned for a FIFO cache of the given size.
+void optimize_vertex_cache(std::vector<Triangle>& triangles, std::size_t vertex_count, std::size_t cache_size = 16);
+
+// Renumbers vertices in the order triangles first reference them, so that
+// vertex data is fetched roughly sequentially. Unreferenced vertices are
+// dropped.
+Mesh optimize_vertex_fetch(Mesh const& mesh);
+
+// Welds the mesh, then optimizes it for vertex cache and fetch locality.
+Mesh optimize_mesh(Mesh const& mesh);
+
+}
@@ -0,0 +1,404 @@
+#include <vcam/render/mesh_optimization.hh>
+#include <vcam/render/mesh_simplification.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <span>
+#include <unordered_map>
+#include <utility>
+
+namespace vcam {
+
+// Symmetric 4x4 matrix whose quadratic form sums the squared distances of a
+// point to a set of planes. Only the upper triangle is stored, row by row.
+struct Quadric {
+    std::array<double, 10> m{};
+
+    static Quadric from_plane(glm::vec3 const& normal, float distance) {
+        double const a = normal.x;
+        double const b = normal.y;
+        double const c = normal.z;
+        double const d = distance;
+        return { {
+            a * a, a * b, a * c, a * d,
+            b * b, b * c, b * d,
+            c * c, c * d,
+            d * d
+        } };
+    }
+
+    Quadric& operator+=(Quadric const& other) {
+        for (std::size_t i = 0; i < m.size(); ++i) {
+            m[i] += other.m[i];
+        }
+        return *this;
+    }
+
+    double evaluate(glm::vec3 const& point) const {
+        double const x = point.x;
+        double const y = point.y;
+        double const z = point.z;
+        return m[0] * x * x + 2 * m[1] * x * y + 2 * m[2] * x * z + 2 * m[3] * x +
+            m[4] * y * y + 2 * m[5] * y * z + 2 * m[6] * y +
+            m[7] * z * z + 2 * m[8] * z +
+            m[9];
+    }
+};
+
+// Candidate collapse of vertex from onto vertex to. Stale once either
+// vertex changed after the candidate was queued.
+struct Collapse {
+    double cost;
+    VertexIndex from;
+    VertexIndex to;
+    std::uint32_t from_version;
+    std::uint32_t to_version;
+
+    bool operator>(Collapse const& other) const {
+        return cost > other.cost;
+    }
+};
+
+static std::uint64_t calculate_edge_key(VertexIndex a, VertexIndex b) {
+    return (static_cast<std::uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+}
+
+static glm::vec3 calculate_face_normal(glm::vec3 const& v0, glm::vec3 const& v1, glm::vec3 const& v2) {
+    return glm::cross(v1 - v0, v2 - v0);
+}
+
+// Closest point to p on triangle abc, from Ericson, "Real-Time Collision
+// Detection", 2004, section 5.1.5.
+static glm::vec3 calculate_closest_point_on_triangle(glm::vec3 const& p, glm::vec3 const& a, glm::vec3 const& b, glm::vec3 const& c) {
+    auto const ab = b - a;
+    auto const ac = c - a;
+    auto const ap = p - a;
+    auto const d1 = glm::dot(ab, ap);
+    auto const d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+
+    auto const bp = p - b;
+    auto const d3 = glm::dot(ab, bp);
+    auto const d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+
+    auto const vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    auto const cp = p - c;
+    auto const d5 = glm::dot(ab, cp);
+    auto const d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+
+    auto const vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    auto const va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    auto const denominator = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denominator) + ac * (vc * denominator);
+}
+
+// Cosine of the largest angle a collapse may turn a triangle's normal by.
+// Turning them further tends to fold thin triangles over their neighbours.
+static constexpr float MAX_NORMAL_DEVIATION = 0.25f;
+
+// Mutable connectivity of a mesh being simplified.
+class Simplifier {
+public:
+    explicit Simplifier(Mesh const& mesh)
+        : m_vertices(mesh.vertices()),
+        m_triangles(mesh.triangles().begin(), mesh.triangles().end()),
+        m_removed_triangles(mesh.triangles().size(), false),
+        m_vertex_triangles(mesh.vertices().size()),
+        m_quadrics(mesh.vertices().size()),
+        m_versions(mesh.vertices().size(), 0),
+        m_locked(mesh.vertices().size(), false),
+        m_collapsed_into(mesh.vertices().size()),
+        m_triangle_count(mesh.triangles().size()) {
+        for (VertexIndex vertex = 0; vertex < m_collapsed_into.size(); ++vertex) {
+            m_collapsed_into[vertex] = vertex;
+        }
+
+        std::unordered_map<std::uint64_t, std::size_t> edge_uses;
+
+        for (std::size_t t = 0; t < m_triangles.size(); ++t) {
+            auto const& triangle = m_triangles[t];
+            auto const& v0 = m_vertices[triangle[0]];
+            auto const& v1 = m_vertices[triangle[1]];
+            auto const& v2 = m_vertices[triangle[2]];
+
+            auto const normal = calculate_face_normal(v0, v1, v2);
+            auto const length = glm::length(normal);
+            auto const plane = length > 0.0f
+                ? Quadric::from_plane(normal / length, -glm::dot(normal / length, v0))
+                : Quadric{};
+
+            for (std::size_t i = 0; i < 3; ++i) {
+                m_vertex_triangles[triangle[i]].push_back(static_cast<std::uint32_t>(t));
+                m_quadrics[triangle[i]] += plane;
+                ++edge_uses[calculate_edge_key(triangle[i], triangle[(i + 1) % 3])];
+            }
+        }
+
+        // Edges used by a single triangle lie on an open boundary or on a
+        // seam between vertices sharing a position but not a normal or
+        // texture coordinates.
+        for (auto const& triangle : m_triangles) {
+            for (std::size_t i = 0; i < 3; ++i) {
+                if (edge_uses[calculate_edge_key(triangle[i], triangle[(i + 1) % 3])] == 1) {
+                    m_locked[triangle[i]] = true;
+                    m_locked[triangle[(i + 1) % 3]] = true;
+                }
+            }
+        }
+
+        for (auto const& triangle : m_triangles) {
+            for (std::size_t i = 0; i < 3; ++i) {
+                // Each interior edge is shared by two triangles, queue it once.
+                if (triangle[i] < triangle[(i + 1) % 3]) {
+                    queue_edge(triangle[i], triangle[(i + 1) % 3]);
+                }
+            }
+        }
+    }
+
+    void simplify(std::size_t target_triangle_count) {
+        while (m_triangle_count > target_triangle_count && !m_queue.empty()) {
+            auto const collapse = m_queue.top();
+            m_queue.pop();
+
+            if (collapse.from_version != m_versions[collapse.from] || collapse.to_version != m_versions[collapse.to]) {
+                continue;
+            }
+
+            if (!is_collapse_valid(collapse.from, collapse.to)) {
+                continue;
+            }
+
+            apply_collapse(collapse.from, collapse.to);
+        }
+    }
+
+    // Quadric costs sum over every plane a vertex absorbed, which makes for
+    // a good ordering but a poor distance. Instead every collapsed vertex is
+    // measured against the nearest of the triangles around the vertex which
+    // took its place.
+    float measure_error() const {
+        auto error = 0.0f;
+
+        for (VertexIndex vertex = 0; vertex < m_vertices.size(); ++vertex) {
+            auto representative = vertex;
+            while (m_collapsed_into[representative] != representative) {
+                representative = m_collapsed_into[representative];
+            }
+
+            if (representative == vertex) {
+                continue;
+            }
+
+            auto distance = std::numeric_limits<float>::infinity();
+            for (auto const t : m_vertex_triangles[representative]) {
+                auto const& triangle = m_triangles[t];
+                auto const closest_point = calculate_closest_point_on_triangle(
+                    m_vertices[vertex],
+                    m_vertices[triangle[0]],
+                    m_vertices[triangle[1]],
+                    m_vertices[triangle[2]]
+                );
+                distance = std::min(distance, glm::length(m_vertices[vertex] - closest_point));
+            }
+
+            if (distance != std::numeric_limits<float>::infinity()) {
+                error = std::max(error, distance);
+            }
+        }
+
+        return error;
+    }
+
+    std::vector<Triangle> remaining_triangles() const {
+        std::vector<Triangle> triangles;
+        triangles.reserve(m_triangle_count);
+        for (std::size_t t = 0; t < m_triangles.size(); ++t) {
+            if (!m_removed_triangles[t]) {
+                triangles.push_back(m_triangles[t]);
+            }
+        }
+        return triangles;
+    }
+
+private:
+    std::span<glm::vec3 const> m_vertices;
+    std::vector<Triangle> m_triangles;
+    std::vector<bool> m_removed_triangles;
+    std::vector<std::vector<std::uint32_t>> m_vertex_triangles;
+    std::vector<Quadric> m_quadrics;
+    std::vector<std::uint32_t> m_versions;
+    std::vector<bool> m_locked;
+    std::vector<VertexIndex> m_collapsed_into;
+    std::size_t m_triangle_count;
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> m_queue;
+
+    // Queues the cheaper direction of the edge which moves an unlocked
+    // vertex.
+    void queue_edge(VertexIndex a, VertexIndex b) {
+        if (m_locked[a] && m_locked[b]) {
+            return;
+        }
+
+        auto quadric = m_quadrics[a];
+        quadric += m_quadrics[b];
+
+        constexpr auto LOCKED = std::numeric_limits<double>::infinity();
+        auto const cost_ab = m_locked[a] ? LOCKED : std::max(quadric.evaluate(m_vertices[b]), 0.0);
+        auto const cost_ba = m_locked[b] ? LOCKED : std::max(quadric.evaluate(m_vertices[a]), 0.0);
+
+        if (cost_ab <= cost_ba) {
+            m_queue.push({ cost_ab, a, b, m_versions[a], m_versions[b] });
+        } else {
+            m_queue.push({ cost_ba, b, a, m_versions[b], m_versions[a] });
+        }
+    }
+
+    void collect_neighbours(VertexIndex vertex, std::vector<VertexIndex>& neighbours) const {
+        neighbours.clear();
+        for (auto const t : m_vertex_triangles[vertex]) {
+            for (auto const index : m_triangles[t]) {
+                if (index != vertex) {
+                    neighbours.push_back(index);
+                }
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    }
+
+    bool is_collapse_valid(VertexIndex from, VertexIndex to) const {
+        // Vertices adjacent to both ends have to be the opposite corners of
+        // the triangles the collapse removes, or the mesh pinches into a
+        // non-manifold edge.
+        std::vector<VertexIndex> from_neighbours;
+        std::vector<VertexIndex> to_neighbours;
+        collect_neighbours(from, from_neighbours);
+        collect_neighbours(to, to_neighbours);
+
+        std::size_t shared_neighbours = 0;
+        std::size_t shared_triangles = 0;
+        for (auto const neighbour : from_neighbours) {
+            shared_neighbours += std::binary_search(to_neighbours.begin(), to_neighbours.end(), neighbour) ? 1 : 0;
+        }
+
+        for (auto const t : m_vertex_triangles[from]) {
+            auto const& triangle = m_triangles[t];
+            if (std::find(triangle.begin(), triangle.end(), to) != triangle.end()) {
+                ++shared_triangles;
+                continue;
+            }
+
+            // Triangles which only move must not flip or collapse.
+            std::array<glm::vec3, 3> moved;
+            for (std::size_t i = 0; i < 3; ++i) {
+                moved[i] = triangle[i] == from ? m_vertices[to] : m_vertices[triangle[i]];
+            }
+
+            auto const before = calculate_face_normal(m_vertices[triangle[0]], m_vertices[triangle[1]], m_vertices[triangle[2]]);
+            auto const after = calculate_face_normal(moved[0], moved[1], moved[2]);
+            if (glm::dot(before, after) <= MAX_NORMAL_DEVIATION * glm::length(before) * glm::length(after)) {
+                return false;
+            }
+        }
+
+        return shared_triangles > 0 && shared_neighbours == shared_triangles;
+    }
+
+    void apply_collapse(VertexIndex from, VertexIndex to) {
+        for (auto const t : m_vertex_triangles[from]) {
+            auto& triangle = m_triangles[t];
+
+            if (std::find(triangle.begin(), triangle.end(), to) == triangle.end()) {
+                std::replace(triangle.begin(), triangle.end(), from, to);
+                m_vertex_triangles[to].push_back(t);
+                continue;
+            }
+
+            m_removed_triangles[t] = true;
+            --m_triangle_count;
+
+            for (auto const index : triangle) {
+                if (index == from) {
+                    continue;
+                }
+                auto& triangles = m_vertex_triangles[index];
+                triangles.erase(std::find(triangles.begin(), triangles.end(), t));
+            }
+        }
+
+        m_vertex_triangles[from].clear();
+        m_collapsed_into[from] = to;
+        m_quadrics[to] += m_quadrics[from];
+        ++m_versions[from];
+        ++m_versions[to];
+
+        std::vector<VertexIndex> neighbours;
+        collect_neighbours(to, neighbours);
+        for (auto const neighbour : neighbours) {
+            queue_edge(to, neighbour);
+        }
+    }
+};
+
+Mesh simplify_mesh(Mesh const& mesh, std::size_t target_triangle_count, float& error) {
+    Simplifier simplifier(mesh);
+    simplifier.simplify(target_triangle_count);
+    error = simplifier.measure_error();
+
+    return optimize_mesh(Mesh(
+        std::vector<glm::vec3>(mesh.vertices().begin(), mesh.vertices().end()),
+        std::vector<glm::vec3>(mesh.normals().begin(), mesh.normals().end()),
+        simplifier.remaining_triangles(),
+        std::vector<glm::vec2>(mesh.texture_coordinates().begin(), mesh.texture_coordinates().end())
+    ));
+}
+
+std::vector<LevelOfDetail> generate_levels_of_detail(Mesh const& mesh, std::size_t max_levels) {
+    std::vector<LevelOfDetail> levels;
+    levels.push_back({ mesh, 0.0f });
+
+    // Every level is simplified from the input mesh, so errors don't
+    // compound across levels.
+    while (levels.size() < max_levels) {
+        auto const previous_triangle_count = levels.back().mesh.triangles().size();
+
+        float error;
+        auto simplified = simplify_mesh(mesh, previous_triangle_count / 2, error);
+        if (simplified.triangles().size() * 4 > previous_triangle_count * 3) {
+            break;
+        }
+
+        levels.push_back({ std::move(simplified), std::max(error, levels.back().error) });
+    }
+
+    return levels;
+}
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <cstddef>
+#include <vector>
+
+namespace vcam {
+
+// Collapses edges in order of increasing quadric error (Garland and
+// Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997)
+// until at most target_triangle_count triangles are left, or no edge can be
+// collapsed without flipping a triangle or tearing the mesh. Every collapse
+// moves one vertex onto the other, so the remaining vertices keep their
+// positions, normals and texture coordinates. Vertices on open boundaries
+// and on seams of normals or texture coordinates stay in place.
+//
+// The error receives an estimate, in model space units, of how far the
+// simplified surface strays from the input vertices.
+Mesh simplify_mesh(Mesh const& mesh, std::size_t target_triangle_count, float& error);
+
+// Halves the triangle count of the mesh with simplify_mesh at every level,
+// stopping after max_levels levels including the mesh itself, or once a
+// level removes less than a quarter of the triangles of the previous one.
+std::vector<LevelOfDetail> generate_levels_of_detail(Mesh const& mesh, std::size_t max_levels = 6);
+
+}
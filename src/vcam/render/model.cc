@@ -0,0 +1,48 @@
+#include <vcam/render/model.hh>
+
+namespace vcam {
+
+// Arrays of a mesh which allocated its own attributes.
+struct MeshStorage {
+    std::vector<glm::vec3> vertices;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texture_coordinates;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+    std::vector<Triangle> triangles;
+};
+
+Mesh::Mesh(
+    std::vector<glm::vec3> vertices,
+    std::vector<glm::vec3> normals,
+    std::vector<Triangle> triangles,
+    std::vector<glm::vec2> texture_coordinates
+) {
+    auto storage = std::make_shared<MeshStorage>();
+    storage->vertices = std::move(vertices);
+    storage->normals = std::move(normals);
+    storage->triangles = std::move(triangles);
+    storage->texture_coordinates = std::move(texture_coordinates);
+
+    storage->x.reserve(storage->vertices.size());
+    storage->y.reserve(storage->vertices.size());
+    storage->z.reserve(storage->vertices.size());
+    for (auto const& vertex : storage->vertices) {
+        storage->x.push_back(vertex.x);
+        storage->y.push_back(vertex.y);
+        storage->z.push_back(vertex.z);
+    }
+
+    m_view.vertices = storage->vertices;
+    m_view.normals = storage->normals;
+    m_view.texture_coordinates = storage->texture_coordinates;
+    m_view.positions = { storage->x, storage->y, storage->z };
+    m_view.triangles = storage->triangles;
+    m_view.bounding_box = calculate_bounding_box(storage->vertices);
+    m_view.bounding_sphere = calculate_bounding_sphere(storage->vertices, m_view.bounding_box);
+
+    m_storage = std::move(storage);
+}
+
+}
@@ -1,37 +1,92 @@
 #pragma once
 
+#include <vcam/render/bounding_volumes.hh>
+#include <vcam/render/texture.hh>
+
 #include <glm/glm.hpp>
 
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace vcam {
 
+using VertexIndex = std::uint32_t;
+using Triangle = std::array<VertexIndex, 3>;
+
+// Vertex positions with one array per coordinate, the layout consumed by the
+// SIMD vertex kernels.
+struct PositionStreams {
+    std::span<float const> x;
+    std::span<float const> y;
+    std::span<float const> z;
+};
+
+// Attributes of a mesh, stored elsewhere. Every vertex attribute has one
+// entry per vertex, except for texture coordinates, which are empty for
+// meshes without them.
+struct MeshView {
+    std::span<glm::vec3 const> vertices;
+    std::span<glm::vec3 const> normals;
+    std::span<glm::vec2 const> texture_coordinates;
+    PositionStreams positions;
+    std::span<Triangle const> triangles;
+    BoundingBox bounding_box;
+    BoundingSphere bounding_sphere;
+};
+
+// Indexed triangle mesh with per-vertex attributes. Attributes never change
+// once the mesh is created, so copies of a mesh share them, along with the
+// storage they live in: either arrays the mesh allocated itself, or e.g. a
+// file mapped into memory.
 class Mesh {
 public:
     explicit Mesh(
         std::vector<glm::vec3> vertices,
-        std::vector<std::array<std::size_t, 3>> triangles,
-        std::vector<std::array<glm::vec3, 3>> triangle_normals
-    )
-        : m_vertices{ vertices }, m_triangles{ triangles }, m_triangle_normals{ triangle_normals } { }
+        std::vector<glm::vec3> normals,
+        std::vector<Triangle> triangles,
+        std::vector<glm::vec2> texture_coordinates = {}
+    );
+
+    // Views attributes which the storage keeps alive.
+    explicit Mesh(MeshView const& view, std::shared_ptr<void const> storage)
+        : m_view{ view }, m_storage{ std::move(storage) } { }
+
+    std::span<glm::vec3 const> vertices() const {
+        return m_view.vertices;
+    }
+
+    std::span<glm::vec3 const> normals() const {
+        return m_view.normals;
+    }
 
-    std::vector<glm::vec3> const& vertices() const {
-        return m_vertices;
+    // Empty if the mesh has none, see Texture for their orientation.
+    std::span<glm::vec2 const> texture_coordinates() const {
+        return m_view.texture_coordinates;
     }
 
-    std::vector<std::array<std::size_t, 3>> const& triangles() const {
-        return m_triangles;
+    PositionStreams const& positions() const {
+        return m_view.positions;
     }
 
-    std::vector<std::array<glm::vec3, 3>> const& triangle_normals() const {
-        return m_triangle_normals;
+    std::span<Triangle const> triangles() const {
+        return m_view.triangles;
+    }
+
+    BoundingBox const& bounding_box() const {
+        return m_view.bounding_box;
+    }
+
+    BoundingSphere const& bounding_sphere() const {
+        return m_view.bounding_sphere;
     }
 
 private:
-    std::vector<glm::vec3> m_vertices;
-    std::vector<std::array<std::size_t, 3>> m_triangles;
-    std::vector<std::array<glm::vec3, 3>> m_triangle_normals;
+    MeshView m_view;
+    std::shared_ptr<void const> m_storage;
 };
 
 class Material {
@@ -41,12 +96,14 @@ public:
         float shininess,
         glm::vec3 specular_reflection,
         glm::vec3 diffuse_reflection,
-        glm::vec3 ambient_reflection
+        glm::vec3 ambient_reflection,
+        std::shared_ptr<Texture const> texture = nullptr
     ) : m_color{ color },
         m_shininess{ shininess },
         m_specular_reflection{ specular_reflection },
         m_diffuse_reflection{ diffuse_reflection },
-        m_ambient_reflection{ ambient_reflection } { }
+        m_ambient_reflection{ ambient_reflection },
+        m_texture{ std::move(texture) } { }
 
     glm::vec3 const& color() const {
         return m_color;
@@ -68,21 +125,44 @@ public:
         return m_ambient_reflection;
     }
 
+    // Multiplies the color, or null. Meshes without texture coordinates are
+    // drawn untextured.
+    Texture const* texture() const {
+        return m_texture.get();
+    }
+
 private:
     glm::vec3 m_color;
     float m_shininess;
     glm::vec3 m_specular_reflection;
     glm::vec3 m_diffuse_reflection;
     glm::vec3 m_ambient_reflection;
+    std::shared_ptr<Texture const> m_texture;
 };
 
+// One level of a model's detail chain. The error bounds how far, in model
+// space units, its surface strays from the surface the chain approximates.
+struct LevelOfDetail {
+    Mesh mesh;
+    float error;
+};
+
+// Levels of detail are ordered from the finest, with increasing errors.
 class Model {
 public:
     explicit Model(Mesh mesh, Material material)
-        : m_mesh{ mesh }, m_material{ material } { }
+        : m_levels_of_detail{ { std::move(mesh), 0.0f } }, m_material{ material } { }
+
+    explicit Model(std::vector<LevelOfDetail> levels_of_detail, Material material)
+        : m_levels_of_detail{ std::move(levels_of_detail) }, m_material{ material } { }
 
+    // The finest level's mesh.
     Mesh const& mesh() const {
-        return m_mesh;
+        return m_levels_of_detail.front().mesh;
+    }
+
+    std::vector<LevelOfDetail> const& levels_of_detail() const {
+        return m_levels_of_detail;
     }
 
     Material const& material() const {
@@ -90,7 +170,7 @@ public:
     }
 
 private:
-    Mesh m_mesh;
+    std::vector<LevelOfDetail> m_levels_of_detail;
     Material  m_material;
 };
 
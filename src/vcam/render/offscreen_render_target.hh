@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vcam/render/render_target.hh>
+
+#include <cstdint>
+#include <vector>
+
+namespace vcam {
+
+// Renders into plain memory, without a window or a GPU renderer, so frames
+// can be produced on headless machines.
+class OffscreenRenderTarget : public IRenderTarget {
+public:
+    explicit OffscreenRenderTarget(int width, int height)
+        : m_width(width),
+        m_height(height),
+        m_pixels(static_cast<std::size_t>(width) * height) { }
+
+    virtual Framebuffer begin_frame() override {
+        return { m_pixels.data(), m_width, m_width, m_height };
+    }
+
+    virtual void end_frame() override { }
+
+    std::vector<std::uint32_t> const& pixels() const {
+        return m_pixels;
+    }
+
+    int width() const {
+        return m_width;
+    }
+
+    int height() const {
+        return m_height;
+    }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<std::uint32_t> m_pixels;
+};
+
+}
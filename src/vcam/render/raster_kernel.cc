@@ -0,0 +1,360 @@
+#include <vcam/core/simd.hh>
+#include <vcam/render/raster_kernel.hh>
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace vcam {
+
+static std::int32_t snap_coordinate(float value) {
+    return static_cast<std::int32_t>(std::lround(value * SUBPIXEL_SCALE));
+}
+
+// Pixel centers lie at half a pixel, 8 in 28.4. Shifts round toward negative
+// infinity, so these give the first and last center within [min, max].
+static int calculate_first_pixel(std::int32_t min) {
+    return (min - SUBPIXEL_SCALE / 2 + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS;
+}
+
+static int calculate_last_pixel(std::int32_t max) {
+    return (max - SUBPIXEL_SCALE / 2) >> SUBPIXEL_BITS;
+}
+
+bool setup_triangle(glm::vec4 const& v0, glm::vec4 const& v1, glm::vec4 const& v2, TriangleSetup& setup) {
+    // Also rejects NaN coordinates, which can't be snapped.
+    if (!std::isfinite(v0.x + v0.y + v1.x + v1.y + v2.x + v2.y)) {
+        return false;
+    }
+
+    std::array<std::int32_t, 3> const xs = { snap_coordinate(v0.x), snap_coordinate(v1.x), snap_coordinate(v2.x) };
+    std::array<std::int32_t, 3> const ys = { snap_coordinate(v0.y), snap_coordinate(v1.y), snap_coordinate(v2.y) };
+
+    auto const bx = std::int64_t(xs[1]) - xs[0];
+    auto const by = std::int64_t(ys[1]) - ys[0];
+    auto const cx = std::int64_t(xs[2]) - xs[0];
+    auto const cy = std::int64_t(ys[2]) - ys[0];
+
+    // Front faces wind counterclockwise on screen, which makes their doubled
+    // signed area negative in viewport space, where y points down. Snapping
+    // can flip or flatten slivers, which are dropped like back faces.
+    auto const doubled_area = bx * cy - by * cx;
+    if (doubled_area >= 0) {
+        return false;
+    }
+
+    // Edge i runs from vertex i to the next one. The edge function is the
+    // doubled area of the triangle a point spans with the edge, negated so
+    // that it is positive inside. Edges pointing down, or left along a
+    // horizontal top, are top-left edges. Pixel centers exactly on any other
+    // edge are excluded by biasing its function by -1.
+    for (int i = 0; i < 3; ++i) {
+        auto const j = (i + 1) % 3;
+        auto const dx = std::int64_t(xs[j]) - xs[i];
+        auto const dy = std::int64_t(ys[j]) - ys[i];
+
+        auto const is_top_left = dy > 0 || (dy == 0 && dx < 0);
+        auto const bias = is_top_left ? 0 : -1;
+
+        auto const a = dy;
+        auto const b = -dx;
+        auto const c = -(a * xs[i] + b * ys[i]) + bias;
+
+        setup.edge_origin[i] = a * (SUBPIXEL_SCALE / 2) + b * (SUBPIXEL_SCALE / 2) + c;
+        setup.edge_dx[i] = static_cast<std::int32_t>(a * SUBPIXEL_SCALE);
+        setup.edge_dy[i] = static_cast<std::int32_t>(b * SUBPIXEL_SCALE);
+    }
+
+    setup.min_x = calculate_first_pixel(std::min({ xs[0], xs[1], xs[2] }));
+    setup.min_y = calculate_first_pixel(std::min({ ys[0], ys[1], ys[2] }));
+    setup.max_x = calculate_last_pixel(std::max({ xs[0], xs[1], xs[2] }));
+    setup.max_y = calculate_last_pixel(std::max({ ys[0], ys[1], ys[2] }));
+
+    // The planes interpolate over the snapped triangle, so that attributes
+    // agree with coverage.
+    auto const scale = 1.0f / SUBPIXEL_SCALE;
+    auto const b = glm::vec2(static_cast<float>(bx), static_cast<float>(by)) * scale;
+    auto const c = glm::vec2(static_cast<float>(cx), static_cast<float>(cy)) * scale;
+    auto const inv_area = 1.0f / (static_cast<float>(doubled_area) * scale * scale);
+
+    setup.origin = glm::vec2(static_cast<float>(xs[0]), static_cast<float>(ys[0])) * scale;
+
+    setup.lambda_origin = glm::vec3(1.0f, 0.0f, 0.0f);
+    setup.lambda_dx = glm::vec3(b.y - c.y, c.y, -b.y) * inv_area;
+    setup.lambda_dy = glm::vec3(c.x - b.x, -c.x, b.x) * inv_area;
+
+    auto const z = glm::vec3(v0.z, v1.z, v2.z);
+    setup.z_origin = v0.z;
+    setup.z_dx = glm::dot(setup.lambda_dx, z);
+    setup.z_dy = glm::dot(setup.lambda_dy, z);
+
+    auto const inv_w = glm::vec3(v0.w, v1.w, v2.w);
+    setup.inv_w_origin = v0.w;
+    setup.inv_w_dx = glm::dot(setup.lambda_dx, inv_w);
+    setup.inv_w_dy = glm::dot(setup.lambda_dy, inv_w);
+
+    setup.nearest_depth = std::max({ v0.z / v0.w, v1.z / v1.w, v2.z / v2.w });
+
+    return true;
+}
+
+static constexpr std::array<glm::ivec2, 1> SAMPLE_PATTERN_1 = { {
+    { 0, 0 }
+} };
+
+static constexpr std::array<glm::ivec2, 4> SAMPLE_PATTERN_4 = { {
+    { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 }
+} };
+
+static constexpr std::array<glm::ivec2, 8> SAMPLE_PATTERN_8 = { {
+    { 1, -3 }, { -1, 3 }, { 5, 1 }, { -3, -5 },
+    { -5, 5 }, { -7, -1 }, { 3, 7 }, { 7, -7 }
+} };
+
+std::span<glm::ivec2 const> sample_pattern(int sample_count) {
+    switch (sample_count) {
+    case 4:
+        return SAMPLE_PATTERN_4;
+
+    case 8:
+        return SAMPLE_PATTERN_8;
+
+    default:
+        return SAMPLE_PATTERN_1;
+    }
+}
+
+// Edge steps are whole multiples of SUBPIXEL_SCALE, so offsets in 1/16 of a
+// pixel move the edge functions by exact integers.
+TriangleSetup offset_triangle_setup(TriangleSetup const& setup, glm::ivec2 offset) {
+    auto offset_setup = setup;
+    for (int i = 0; i < 3; ++i) {
+        offset_setup.edge_origin[i] +=
+            (std::int64_t(setup.edge_dx[i]) * offset.x + std::int64_t(setup.edge_dy[i]) * offset.y) / SUBPIXEL_SCALE;
+    }
+
+    // The planes are evaluated relative to the origin, so moving it the
+    // other way moves every point they're evaluated at by the offset.
+    offset_setup.origin -= glm::vec2(static_cast<float>(offset.x), static_cast<float>(offset.y)) / static_cast<float>(SUBPIXEL_SCALE);
+
+    return offset_setup;
+}
+
+// Edge functions only need their sign. Values beyond the limit keep it for
+// the whole row, since a row of MAX_ROW_PIXELS steps moves them by less than
+// the limit within the guard band, so they can be clamped to 32 bits.
+constexpr std::int64_t EDGE_LIMIT = std::int64_t(1) << 30;
+
+struct RowStart {
+    std::array<std::int32_t, 3> edges;
+    float z;
+    float inv_w;
+};
+
+static RowStart calculate_row_start(TriangleSetup const& setup, int x, int y) {
+    RowStart start;
+    for (int i = 0; i < 3; ++i) {
+        auto const edge = setup.edge_origin[i] + std::int64_t(setup.edge_dx[i]) * x + std::int64_t(setup.edge_dy[i]) * y;
+        start.edges[i] = static_cast<std::int32_t>(std::clamp(edge, -EDGE_LIMIT, EDGE_LIMIT));
+    }
+
+    auto const dx = x + 0.5f - setup.origin.x;
+    auto const dy = y + 0.5f - setup.origin.y;
+
+    start.z = setup.z_origin + setup.z_dx * dx + setup.z_dy * dy;
+    start.inv_w = setup.inv_w_origin + setup.inv_w_dx * dx + setup.inv_w_dy * dy;
+
+    return start;
+}
+
+static std::uint64_t calculate_row_mask(int count) {
+    return count >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << count) - 1;
+}
+
+static std::uint64_t rasterize_row_scalar(
+    TriangleSetup const& setup,
+    int x,
+    int y,
+    int count,
+    float const* depth_row,
+    float* depths,
+    std::uint64_t& coverage
+) {
+    auto start = calculate_row_start(setup, x, y);
+
+    std::uint64_t mask = 0;
+    coverage = 0;
+    for (int i = 0; i < count; ++i) {
+        auto const depth = start.z / start.inv_w;
+        depths[i] = depth;
+
+        // A pixel is covered if no edge function is negative.
+        auto const covered = (start.edges[0] | start.edges[1] | start.edges[2]) >= 0;
+        if (covered) {
+            coverage |= std::uint64_t(1) << i;
+            if (depth > depth_row[i]) {
+                mask |= std::uint64_t(1) << i;
+            }
+        }
+
+        for (int e = 0; e < 3; ++e) {
+            start.edges[e] += setup.edge_dx[e];
+        }
+        start.z += setup.z_dx;
+        start.inv_w += setup.inv_w_dx;
+    }
+
+    return mask;
+}
+
+#ifdef VCAM_X86
+
+// Lanes past the end of the row test against a copy of the depth row padded
+// with +inf, which no depth can pass, so loads never leave the buffer.
+template <std::size_t Lanes>
+static float const* pad_depth_row(float const* depth_row, int i, int count, std::array<float, Lanes>& padded) {
+    if (i + static_cast<int>(Lanes) <= count) {
+        return depth_row + i;
+    }
+
+    padded.fill(std::numeric_limits<float>::infinity());
+    std::copy(depth_row + i, depth_row + count, padded.begin());
+    return padded.data();
+}
+
+static std::uint64_t rasterize_row_sse(
+    TriangleSetup const& setup,
+    int x,
+    int y,
+    int count,
+    float const* depth_row,
+    float* depths,
+    std::uint64_t& coverage
+) {
+    auto const start = calculate_row_start(setup, x, y);
+
+    auto const offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    auto const negative = _mm_set1_epi32(-1);
+
+    auto const edge_lanes = [&](int e) {
+        auto const edge = start.edges[e];
+        auto const dx = setup.edge_dx[e];
+        return _mm_setr_epi32(edge, edge + dx, edge + dx * 2, edge + dx * 3);
+        };
+
+    auto e0 = edge_lanes(0);
+    auto e1 = edge_lanes(1);
+    auto e2 = edge_lanes(2);
+    auto z = _mm_add_ps(_mm_set1_ps(start.z), _mm_mul_ps(_mm_set1_ps(setup.z_dx), offsets));
+    auto inv_w = _mm_add_ps(_mm_set1_ps(start.inv_w), _mm_mul_ps(_mm_set1_ps(setup.inv_w_dx), offsets));
+
+    auto const e0_step = _mm_set1_epi32(setup.edge_dx[0] * 4);
+    auto const e1_step = _mm_set1_epi32(setup.edge_dx[1] * 4);
+    auto const e2_step = _mm_set1_epi32(setup.edge_dx[2] * 4);
+    auto const z_step = _mm_set1_ps(setup.z_dx * 4.0f);
+    auto const inv_w_step = _mm_set1_ps(setup.inv_w_dx * 4.0f);
+
+    std::array<float, 4> padded;
+
+    std::uint64_t mask = 0;
+    coverage = 0;
+    for (int i = 0; i < count; i += 4) {
+        auto const edges = _mm_or_si128(_mm_or_si128(e0, e1), e2);
+        auto const covered = _mm_castsi128_ps(_mm_cmpgt_epi32(edges, negative));
+
+        auto const depth = _mm_div_ps(z, inv_w);
+        _mm_storeu_ps(depths + i, depth);
+
+        auto const buffer = _mm_loadu_ps(pad_depth_row(depth_row, i, count, padded));
+        auto const passed = _mm_and_ps(covered, _mm_cmpgt_ps(depth, buffer));
+
+        mask |= static_cast<std::uint64_t>(_mm_movemask_ps(passed)) << i;
+        coverage |= static_cast<std::uint64_t>(_mm_movemask_ps(covered)) << i;
+
+        e0 = _mm_add_epi32(e0, e0_step);
+        e1 = _mm_add_epi32(e1, e1_step);
+        e2 = _mm_add_epi32(e2, e2_step);
+        z = _mm_add_ps(z, z_step);
+        inv_w = _mm_add_ps(inv_w, inv_w_step);
+    }
+
+    coverage &= calculate_row_mask(count);
+    return mask & calculate_row_mask(count);
+}
+
+VCAM_TARGET_AVX2
+static std::uint64_t rasterize_row_avx2(
+    TriangleSetup const& setup,
+    int x,
+    int y,
+    int count,
+    float const* depth_row,
+    float* depths,
+    std::uint64_t& coverage
+) {
+    auto const start = calculate_row_start(setup, x, y);
+
+    auto const offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    auto const lane_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    auto const negative = _mm256_set1_epi32(-1);
+
+    auto e0 = _mm256_add_epi32(_mm256_set1_epi32(start.edges[0]), _mm256_mullo_epi32(_mm256_set1_epi32(setup.edge_dx[0]), lane_offsets));
+    auto e1 = _mm256_add_epi32(_mm256_set1_epi32(start.edges[1]), _mm256_mullo_epi32(_mm256_set1_epi32(setup.edge_dx[1]), lane_offsets));
+    auto e2 = _mm256_add_epi32(_mm256_set1_epi32(start.edges[2]), _mm256_mullo_epi32(_mm256_set1_epi32(setup.edge_dx[2]), lane_offsets));
+    auto z = _mm256_add_ps(_mm256_set1_ps(start.z), _mm256_mul_ps(_mm256_set1_ps(setup.z_dx), offsets));
+    auto inv_w = _mm256_add_ps(_mm256_set1_ps(start.inv_w), _mm256_mul_ps(_mm256_set1_ps(setup.inv_w_dx), offsets));
+
+    auto const e0_step = _mm256_set1_epi32(setup.edge_dx[0] * 8);
+    auto const e1_step = _mm256_set1_epi32(setup.edge_dx[1] * 8);
+    auto const e2_step = _mm256_set1_epi32(setup.edge_dx[2] * 8);
+    auto const z_step = _mm256_set1_ps(setup.z_dx * 8.0f);
+    auto const inv_w_step = _mm256_set1_ps(setup.inv_w_dx * 8.0f);
+
+    std::array<float, 8> padded;
+
+    std::uint64_t mask = 0;
+    coverage = 0;
+    for (int i = 0; i < count; i += 8) {
+        auto const edges = _mm256_or_si256(_mm256_or_si256(e0, e1), e2);
+        auto const covered = _mm256_castsi256_ps(_mm256_cmpgt_epi32(edges, negative));
+
+        auto const depth = _mm256_div_ps(z, inv_w);
+        _mm256_storeu_ps(depths + i, depth);
+
+        auto const buffer = _mm256_loadu_ps(pad_depth_row(depth_row, i, count, padded));
+        auto const passed = _mm256_and_ps(covered, _mm256_cmp_ps(depth, buffer, _CMP_GT_OQ));
+
+        mask |= static_cast<std::uint64_t>(_mm256_movemask_ps(passed)) << i;
+        coverage |= static_cast<std::uint64_t>(_mm256_movemask_ps(covered)) << i;
+
+        e0 = _mm256_add_epi32(e0, e0_step);
+        e1 = _mm256_add_epi32(e1, e1_step);
+        e2 = _mm256_add_epi32(e2, e2_step);
+        z = _mm256_add_ps(z, z_step);
+        inv_w = _mm256_add_ps(inv_w, inv_w_step);
+    }
+
+    coverage &= calculate_row_mask(count);
+    return mask & calculate_row_mask(count);
+}
+
+#endif
+
+RowKernel select_row_kernel() {
+#ifdef VCAM_X86
+    if (SDL_HasAVX2()) {
+        return rasterize_row_avx2;
+    }
+
+    if (SDL_HasSSE2()) {
+        return rasterize_row_sse;
+    }
+#endif
+
+    return rasterize_row_scalar;
+}
+
+}
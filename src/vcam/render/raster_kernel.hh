@@ -0,0 +1,102 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace vcam {
+
+// Vertices are snapped to 28.4 fixed point, 1/16 of a pixel, before setup.
+constexpr int SUBPIXEL_BITS = 4;
+constexpr int SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+
+// Edge functions and plane equations of a screen-space triangle, computed once
+// per triangle from its snapped vertices.
+//
+// Coverage is decided exactly by the integer edge functions, which are
+// positive inside the triangle and biased so that pixel centers on an edge
+// belong to the triangle only if it is a top or left edge. Triangles sharing
+// an edge therefore cover every pixel along it exactly once.
+//
+// The barycentric and depth planes are only used for interpolation. They are
+// expressed relative to the first vertex so that large viewport coordinates
+// don't cancel each other out.
+struct TriangleSetup {
+    // Values at the center of pixel (0, 0) and steps per pixel in x and y.
+    std::array<std::int64_t, 3> edge_origin;
+    std::array<std::int32_t, 3> edge_dx;
+    std::array<std::int32_t, 3> edge_dy;
+
+    // Pixels whose centers lie within the bounding box of the snapped
+    // vertices, not clipped to the viewport.
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+
+    glm::vec2 origin;
+
+    glm::vec3 lambda_origin;
+    glm::vec3 lambda_dx;
+    glm::vec3 lambda_dy;
+
+    float z_origin;
+    float z_dx;
+    float z_dy;
+
+    float inv_w_origin;
+    float inv_w_dx;
+    float inv_w_dy;
+
+    // Largest reverse depth over the triangle, reached at one of its vertices.
+    float nearest_depth;
+
+    glm::vec3 barycentric_coordinates(float x, float y) const {
+        auto const dx = x - origin.x;
+        auto const dy = y - origin.y;
+        return lambda_origin + lambda_dx * dx + lambda_dy * dy;
+    }
+};
+
+// Returns false for triangles that are back facing or degenerate after
+// snapping, which cover no pixels. Vertices must lie within the guard band,
+// so that the edge functions can be stepped across a row in 32 bits.
+bool setup_triangle(glm::vec4 const& v0, glm::vec4 const& v1, glm::vec4 const& v2, TriangleSetup& setup);
+
+constexpr int MAX_SAMPLES = 8;
+
+// Positions of the samples of a pixel relative to its center, in 1/16 of a
+// pixel, for 1, 4 or 8 samples. They're the standard rotated patterns, which
+// spread over distinct rows and columns so that near horizontal and near
+// vertical edges get as many coverage steps as there are samples.
+std::span<glm::ivec2 const> sample_pattern(int sample_count);
+
+// Setup of the same triangle with pixel centers moved by a sample offset, in
+// 1/16 of a pixel, so that the row kernels scan that sample of every pixel
+// instead. Coverage moves exactly, including the top-left rule, and so do
+// the planes. The bounding box is left unchanged.
+TriangleSetup offset_triangle_setup(TriangleSetup const& setup, glm::ivec2 offset);
+
+constexpr int MAX_ROW_PIXELS = 64;
+
+// Scans pixel centers [x, x + count) of row y, with count <= MAX_ROW_PIXELS.
+// depths[i] receives the interpolated depth of pixel x + i and bit i of the
+// result is set if that pixel is covered and closer than depth_row[i].
+// Bit i of coverage is set if the pixel is covered, whatever its depth.
+// The depths array must have room for MAX_ROW_PIXELS values.
+using RowKernel = std::uint64_t (*)(
+    TriangleSetup const& setup,
+    int x,
+    int y,
+    int count,
+    float const* depth_row,
+    float* depths,
+    std::uint64_t& coverage
+);
+
+// Picks the widest kernel the running CPU supports.
+RowKernel select_row_kernel();
+
+}
@@ -1,15 +1,70 @@
-#include <vcam/core/math.hh>
 #include <vcam/render/render_component.hh>
 
 namespace vcam {
 
-void RenderComponent::on_update(Entity& entity, float dt) {
-    auto const model_to_scene_transform = calculate_transform_matrix(
-        entity.position(),
-        entity.rotation(),
-        entity.scale()
-    );
-    m_render_system.add_instance(*m_model.get(), model_to_scene_transform);
+// The frame in flight may still draw the removed instances, so their models
+// are handed to the render system rather than released here.
+RenderComponents::~RenderComponents() {
+    for (std::size_t i = 0; i < instances.size(); ++i) {
+        if (instances[i]) {
+            m_render_system.remove_instance(*instances[i]);
+            m_render_system.release_after_frame(std::move(models[i]));
+        }
+    }
+}
+
+void RenderComponents::insert(Entity entity, std::shared_ptr<Model> model) {
+    insert_entity(entity);
+    models.push_back(std::move(model));
+    instances.push_back(std::nullopt);
+    added_entities.push_back(entity);
+}
+
+void RenderComponents::remove(Entity entity) {
+    if (!contains(entity)) {
+        return;
+    }
+
+    auto const entity_index = index(entity);
+    if (auto const& instance = instances[entity_index]) {
+        m_render_system.remove_instance(*instance);
+        m_render_system.release_after_frame(std::move(models[entity_index]));
+    }
+
+    remove_swapped(remove_entity(entity), models, instances);
+}
+
+// Entities which didn't move keep their instances as they are, so scenes
+// which are mostly static cost next to nothing per frame.
+void RenderComponentSystem::on_render(Scene& scene, float t) {
+    auto& renders = scene.pool<RenderComponents>();
+    auto const& transforms = scene.transforms();
+    auto& render_system = renders.render_system();
+
+    for (auto const entity : transforms.changed_entities()) {
+        if (!renders.contains(entity)) {
+            continue;
+        }
+
+        auto const& instance = renders.instances[renders.index(entity)];
+        if (instance) {
+            render_system.update_instance(*instance, transforms.local_to_scene_transform(transforms.index(entity)));
+        }
+    }
+
+    for (auto const entity : renders.added_entities) {
+        if (!renders.contains(entity)) {
+            continue;
+        }
+
+        auto const index = renders.index(entity);
+        if (!renders.instances[index]) {
+            auto const& model_to_scene_transform = transforms.local_to_scene_transform(transforms.index(entity));
+            renders.instances[index] = render_system.add_instance(*renders.models[index], model_to_scene_transform);
+        }
+    }
+
+    renders.added_entities.clear();
 }
 
 }
@@ -1,21 +1,51 @@
 #pragma once
 
-#include <vcam/core/entity.hh>
+#include <vcam/core/component_pool.hh>
+#include <vcam/core/scene.hh>
 #include <vcam/render/model.hh>
 #include <vcam/render/render_system.hh>
 
+#include <memory>
+#include <optional>
+#include <vector>
+
 namespace vcam {
 
-class RenderComponent : public IComponent {
+// Models drawn at the transforms of entities, as instances of the render
+// system. Instances are removed along with their components.
+class RenderComponents : public ComponentPool {
 public:
-    explicit RenderComponent(RenderSystem& render_system, std::shared_ptr<Model> model)
-        : m_render_system(render_system), m_model(model) { }
+    std::vector<std::shared_ptr<Model>> models;
+
+    // Added to the render system when first rendered.
+    std::vector<std::optional<InstanceId>> instances;
+
+    // Entities whose instances are yet to be added. May hold entities which
+    // have since been removed.
+    std::vector<Entity> added_entities;
+
+    explicit RenderComponents(RenderSystem& render_system)
+        : m_render_system(render_system) { }
+
+    ~RenderComponents();
 
-    virtual void on_update(Entity& entity, float dt) override;
+    RenderSystem& render_system() {
+        return m_render_system;
+    }
+
+    void insert(Entity entity, std::shared_ptr<Model> model);
+
+    virtual void remove(Entity entity) override;
 
 private:
     RenderSystem& m_render_system;
-    std::shared_ptr<Model> m_model;
+};
+
+// Hands the transforms of entities with render components to the render
+// system, as far as they changed since the last frame.
+class RenderComponentSystem : public ISystem {
+public:
+    virtual void on_render(Scene& scene, float t) override;
 };
 
 }
@@ -1,81 +1,680 @@
 #include <vcam/core/math.hh>
+#include <vcam/core/profiler.hh>
 #include <vcam/render/render_system.hh>
 
+#include <SDL3/SDL_assert.h>
+#include <SDL3/SDL_log.h>
+
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <utility>
 
 namespace vcam {
 
-void RenderSystem::add_instance(Model const& model, glm::mat4 model_to_scene_transform) {
-    m_models.insert(std::make_pair(&model, model_to_scene_transform));
+static_assert(RenderSystem::TILE_SIZE <= MAX_ROW_PIXELS);
+
+InstanceId RenderSystem::add_instance(Model const& model, glm::mat4 model_to_scene_transform) {
+    InstanceId id;
+    if (!m_free_instances.empty()) {
+        id = m_free_instances.back();
+        m_free_instances.pop_back();
+    } else {
+        id = static_cast<InstanceId>(m_instances.size());
+        m_instances.emplace_back();
+    }
+
+    m_instances[id] = { &model, nullptr, model_to_scene_transform };
+    m_instance_changes.push_back({
+        InstanceChangeType::INSERT,
+        id,
+        transform_bounding_box(model.mesh().bounding_box(), model_to_scene_transform)
+        });
+
+    return id;
+}
+
+void RenderSystem::update_instance(InstanceId id, glm::mat4 model_to_scene_transform) {
+    auto& instance = m_instances[id];
+    if (instance.model_to_scene_transform == model_to_scene_transform) {
+        return;
+    }
+
+    instance.model_to_scene_transform = model_to_scene_transform;
+    m_instance_changes.push_back({
+        InstanceChangeType::UPDATE,
+        id,
+        transform_bounding_box(instance.model->mesh().bounding_box(), model_to_scene_transform)
+        });
+}
+
+void RenderSystem::remove_instance(InstanceId id) {
+    m_instances[id].model = nullptr;
+    m_free_instances.push_back(id);
+    m_instance_changes.push_back({ InstanceChangeType::REMOVE, id, {} });
+}
+
+InstanceId RenderSystem::add_instances(
+    Model const& model,
+    std::span<glm::mat4 const> model_to_scene_transforms,
+    std::span<Material const> materials
+) {
+    // Free slots are left alone, so the new ids are consecutive.
+    auto const first = static_cast<InstanceId>(m_instances.size());
+    auto const& bounding_box = model.mesh().bounding_box();
+
+    // Instances of a mismatched call still get added, so the returned ids
+    // stay valid, but with the model's material.
+    SDL_assert(materials.empty() || materials.size() == model_to_scene_transforms.size());
+    auto const has_materials = !materials.empty() && materials.size() == model_to_scene_transforms.size();
+    if (!materials.empty() && !has_materials) {
+        SDL_LogError(
+            SDL_LOG_CATEGORY_APPLICATION,
+            "%zu materials given for %zu instances, using the model's material",
+            materials.size(),
+            model_to_scene_transforms.size()
+        );
+    }
+
+    m_instances.reserve(m_instances.size() + model_to_scene_transforms.size());
+    for (std::size_t i = 0; i < model_to_scene_transforms.size(); ++i) {
+        auto const* const material = has_materials ? &materials[i] : nullptr;
+        m_instances.push_back({ &model, material, model_to_scene_transforms[i] });
+        m_instance_changes.push_back({
+            InstanceChangeType::INSERT,
+            first + static_cast<InstanceId>(i),
+            transform_bounding_box(bounding_box, model_to_scene_transforms[i])
+            });
+    }
+
+    return first;
+}
+
+void RenderSystem::update_instances(InstanceId first, std::span<glm::mat4 const> model_to_scene_transforms) {
+    for (std::size_t i = 0; i < model_to_scene_transforms.size(); ++i) {
+        update_instance(first + static_cast<InstanceId>(i), model_to_scene_transforms[i]);
+    }
+}
+
+void RenderSystem::remove_instances(InstanceId first, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        remove_instance(first + static_cast<InstanceId>(i));
+    }
+}
+
+LightId RenderSystem::add_light(Light const& light) {
+    LightId id;
+    if (!m_free_lights.empty()) {
+        id = m_free_lights.back();
+        m_free_lights.pop_back();
+    } else {
+        id = static_cast<LightId>(m_lights.size());
+        m_lights.emplace_back();
+    }
+
+    m_lights[id] = light;
+    return id;
+}
+
+void RenderSystem::update_light(LightId id, Light const& light) {
+    m_lights[id] = light;
 }
 
+void RenderSystem::remove_light(LightId id) {
+    m_lights[id].radius = 0.0f;
+    m_free_lights.push_back(id);
+}
+
+static constexpr float Z_NEAR = 0.01f;
+static constexpr float Z_FAR = 1000.0f;
+
 static glm::mat4 calculate_scene_to_camera_transform(Camera const& camera);
 static glm::mat4 calculate_camera_to_projection_transform(Camera const& camera, float aspect_ratio);
 static glm::mat4 calculate_projection_to_viewport_transform(int width, int height);
 
+struct InstanceTransforms {
+    glm::mat4 model_to_viewport;
+    glm::mat3 normal;
+};
+
+// Pixels and nearest depth an instance may cover. The rectangle is empty if
+// the instance is entirely off screen.
+struct InstanceBounds {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    float nearest_depth;
+};
+
+static std::size_t select_level_of_detail(
+    std::vector<LevelOfDetail> const& levels,
+    std::size_t current_level,
+    float pixels_per_unit,
+    float threshold
+);
+
+static InstanceBounds calculate_instance_bounds(
+    BoundingSphere const& sphere,
+    glm::mat4 const& model_to_camera_transform,
+    glm::mat4 const& camera_to_projection_transform,
+    glm::mat4 const& projection_to_viewport_transform,
+    int width,
+    int height
+);
+
+static int calculate_sample_count(Multisampling multisampling);
+
+using Clock = std::chrono::steady_clock;
+
+static double lap_milliseconds(Clock::time_point& since);
+static void record_statistics(FrameStatistics const& statistics);
+
 void RenderSystem::render() {
-    int width, height;
-    SDL_GetRenderOutputSize(m_renderer, &width, &height);
+    finish_frame();
 
-    SDL_SetRenderDrawColorFloat(m_renderer, 1.0f, 1.0f, 1.0f, SDL_ALPHA_OPAQUE_FLOAT);
-    SDL_RenderClear(m_renderer);
+    begin_frame();
+    render_frame();
+    present_frame();
+}
 
-    m_surface = SDL_CreateSurface(
-        width,
-        height,
-        SDL_PIXELFORMAT_RGBA8888
-    );
-    SDL_ClearSurface(m_surface, 1.0f, 1.0f, 1.0f, 1.0f);
+void RenderSystem::submit_frame() {
+    finish_frame();
 
-    auto const scene_to_camera_transform = calculate_scene_to_camera_transform(m_camera);
+    begin_frame();
 
-    auto const camera_to_projection_transform = calculate_camera_to_projection_transform(m_camera, static_cast<float>(width) / height);
+    if (m_render_thread == nullptr) {
+        m_render_thread = std::make_unique<WorkerThread>();
+    }
+
+    m_render_thread->submit([this] { render_frame(); });
+    m_frame_in_flight = true;
+}
+
+void RenderSystem::finish_frame() {
+    if (!m_frame_in_flight) {
+        return;
+    }
+
+    m_render_thread->wait();
+    m_frame_in_flight = false;
+    m_released_resources.clear();
+
+    present_frame();
+}
+
+void RenderSystem::release_after_frame(std::shared_ptr<void const> resource) {
+    if (m_frame_in_flight) {
+        m_released_resources.push_back(std::move(resource));
+    }
+}
+
+// Runs on the submitting thread, as render targets may only be usable from
+// the thread which created them.
+void RenderSystem::begin_frame() {
+    ProfileScope profile_scope("snapshot");
+    auto lap_start = Clock::now();
+
+    // Assigning reuses the snapshot's storage, and swapping hands the
+    // emptied change list back, so neither allocates once they've grown.
+    m_frame.camera = m_camera;
+    m_frame.shading_mode = m_shading_mode;
+    m_frame.multisampling = m_multisampling;
+    m_frame.texture_filtering = m_texture_filtering;
+    m_frame.occlusion_culling = m_occlusion_culling;
+    m_frame.level_of_detail_threshold = m_level_of_detail_threshold;
+    m_frame.resolve_settings = m_resolve_settings;
+    m_frame.resolution_scale = m_resolution_controller.scale();
+    m_frame.lights = m_lights;
+
+    m_frame.instance_changes.swap(m_instance_changes);
+    m_instance_changes.clear();
+
+    // Every change to an instance is logged, so only the instances which
+    // changed since the last snapshot have to be copied into this one.
+    m_frame.instances.resize(m_instances.size());
+    for (auto const& change : m_frame.instance_changes) {
+        m_frame.instances[change.id] = m_instances[change.id];
+    }
+
+    m_framebuffer = m_target->begin_frame();
+
+    m_frame_timings = {};
+    m_frame_timings.begin = lap_milliseconds(lap_start);
+}
+
+void RenderSystem::present_frame() {
+    auto lap_start = Clock::now();
+
+    {
+        ProfileScope profile_scope("present");
+        m_target->end_frame();
+        m_framebuffer = {};
+    }
+
+    m_frame_timings.present = lap_milliseconds(lap_start);
+    m_frame_timings.total += m_frame_timings.present;
+
+    m_resolution_controller.update(m_frame_timings.raster + m_frame_timings.upscale);
+
+    m_last_frame_timings = m_frame_timings;
+    m_last_frame_statistics = m_frame_statistics;
+}
+
+void RenderSystem::apply_instance_changes() {
+    m_visible_instances.resize(m_frame.instances.size(), true);
+    m_instance_levels_of_detail.resize(m_frame.instances.size(), 0);
+
+    for (auto const& change : m_frame.instance_changes) {
+        switch (change.type) {
+        case InstanceChangeType::INSERT:
+            m_visible_instances[change.id] = true;
+            m_instance_levels_of_detail[change.id] = 0;
+            m_instance_hierarchy.insert(change.id, change.bounds);
+            break;
+
+        case InstanceChangeType::UPDATE:
+            m_instance_hierarchy.update(change.id, change.bounds);
+            break;
+
+        case InstanceChangeType::REMOVE:
+            m_instance_hierarchy.remove(change.id);
+            break;
+        }
+    }
+
+    m_frame.instance_changes.clear();
+}
+
+void RenderSystem::render_frame() {
+    ProfileScope profile_scope("frame");
+    auto const frame_start = Clock::now();
+    auto lap_start = frame_start;
+
+    auto timings = m_frame_timings;
+
+    // Even frames with nothing to draw into have to keep up with the scene.
+    apply_instance_changes();
+
+    if (m_framebuffer.pixels == nullptr || m_framebuffer.width <= 0 || m_framebuffer.height <= 0) {
+        return;
+    }
+
+    // Everything up to the upscale happens at the scaled resolution.
+    auto const width = std::max(static_cast<int>(std::lround(m_framebuffer.width * m_frame.resolution_scale)), 1);
+    auto const height = std::max(static_cast<int>(std::lround(m_framebuffer.height * m_frame.resolution_scale)), 1);
+    auto const is_upscaled = width != m_framebuffer.width || height != m_framebuffer.height;
+
+    auto const& camera = m_frame.camera;
+    auto const scene_to_camera_transform = calculate_scene_to_camera_transform(camera);
+
+    auto const camera_to_projection_transform = calculate_camera_to_projection_transform(camera, static_cast<float>(width) / height);
     auto const projection_to_camera_transform = glm::inverse(camera_to_projection_transform);
 
     auto const projection_to_viewport_transform = calculate_projection_to_viewport_transform(width, height);
     auto const viewport_to_projection_transform = glm::inverse(projection_to_viewport_transform);
 
-    m_light.position = glm::vec3(scene_to_camera_transform * glm::vec4(m_light.position, 1.0f));
-    std::vector<float> depth_buffer(
-        width * height,
-        -std::numeric_limits<float>::infinity()
-    );
+    auto const camera_to_viewport_transform = projection_to_viewport_transform * camera_to_projection_transform;
+    auto const viewport_size = glm::vec2(width, height);
+
+    // Pixels spanned by a unit length facing the camera at unit distance.
+    auto const projection_scale = height * 0.5f * camera_to_projection_transform[1][1];
+
+    // Visibility records are kept per pixel, so only forward shading can
+    // multisample.
+    auto const sample_count = m_frame.shading_mode == ShadingMode::FORWARD
+        ? calculate_sample_count(m_frame.multisampling)
+        : 1;
+
+    // Tiles clear their own part of the buffers before rasterizing.
+    auto const pixel_count = static_cast<std::size_t>(width) * height;
+    m_color_buffer.red.resize(pixel_count);
+    m_color_buffer.green.resize(pixel_count);
+    m_color_buffer.blue.resize(pixel_count);
+    m_depth_buffer.resize(pixel_count);
+    if (m_frame.shading_mode == ShadingMode::VISIBILITY) {
+        m_visibility_buffer.resize(pixel_count);
+    }
+    if (sample_count > 1) {
+        m_sample_depths.resize(pixel_count * sample_count);
+    }
+
+    m_tile_columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tile_rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_tile_bins.resize(static_cast<std::size_t>(m_tile_columns) * m_tile_rows);
+    for (auto& bin : m_tile_bins) {
+        bin.clear();
+    }
+
+    m_tile_statistics.assign(m_tile_bins.size(), FrameStatistics{});
+    if (sample_count > 1) {
+        m_tile_samples.resize(m_tile_bins.size());
+    }
+    m_depth_pyramid.resize(width, height);
+
+    if (is_upscaled) {
+        m_scaled_pixels.resize(pixel_count);
+        m_resolve_target = { m_scaled_pixels.data(), width, width, height };
+        m_upscaler.resize(width, height, m_framebuffer.width, m_framebuffer.height);
+    } else {
+        m_resolve_target = m_framebuffer;
+    }
+
+    timings.begin += lap_milliseconds(lap_start);
 
-    for (auto const& [model, model_to_scene_transform] : m_models) {
-        auto const model_to_camera_transform = scene_to_camera_transform * model_to_scene_transform;
+    // Only instances the hierarchy finds inside the frustum go any further.
+    // They're grouped by model, then ordered by id, which doesn't depend on
+    // the tree.
+    {
+        ProfileScope culling_scope("culling");
+        m_instance_hierarchy.commit();
 
-        ScratchModel scratch(*model);
+        auto const frustum = calculate_frustum(camera_to_projection_transform * scene_to_camera_transform);
+        m_frustum_instances.clear();
+        m_instance_hierarchy.query(frustum, m_frustum_instances);
+        std::sort(m_frustum_instances.begin(), m_frustum_instances.end(), [&](InstanceId a, InstanceId b) {
+            auto const* const model_a = m_frame.instances[a].model;
+            auto const* const model_b = m_frame.instances[b].model;
+            return model_a != model_b ? std::less<>{}(model_a, model_b) : a < b;
+            });
 
-        transform_model(scratch, model_to_camera_transform);
-        project_model(scratch, camera_to_projection_transform);
-        clip_model(scratch);
-        normalize_model(scratch);
-        viewport_model(scratch, projection_to_viewport_transform);
+        m_scratch_models.reserve(m_frustum_instances.size());
 
-        rasterize_model(
-            scratch,
+        cluster_lights(scene_to_camera_transform, camera_to_projection_transform, projection_to_viewport_transform, width, height);
+    }
+
+    timings.culling += lap_milliseconds(lap_start);
+
+    // Geometry stages count into this, tiles into their own statistics.
+    FrameStatistics statistics{};
+
+    // Instances sharing a model go through each geometry stage together,
+    // so the model's mesh stays in cache from one instance to the next.
+    auto const process_batch = [&](std::span<InstanceId const> ids) {
+        auto const& model = *m_frame.instances[ids.front()].model;
+        auto const& levels = model.levels_of_detail();
+        auto const& sphere = model.mesh().bounding_sphere();
+        auto const first_scratch = m_scratch_models.size();
+
+        ProfileScope transform_scope("transform");
+
+        std::pmr::vector<InstanceTransforms> transforms(ids.size(), &m_frame_arena);
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            auto const& instance = m_frame.instances[ids[i]];
+            auto const model_to_camera_transform = scene_to_camera_transform * instance.model_to_scene_transform;
+            transforms[i].model_to_viewport = camera_to_viewport_transform * model_to_camera_transform;
+            transforms[i].normal = glm::transpose(glm::inverse(glm::mat3(model_to_camera_transform)));
+
+            // Errors are scaled like the bounding sphere, and projected from
+            // the point of it nearest to the camera.
+            auto const scale = std::max({
+                glm::length(glm::vec3(model_to_camera_transform[0])),
+                glm::length(glm::vec3(model_to_camera_transform[1])),
+                glm::length(glm::vec3(model_to_camera_transform[2]))
+                });
+            auto const center = glm::vec3(model_to_camera_transform * glm::vec4(sphere.center, 1.0f));
+            auto const distance = glm::length(center) - sphere.radius * scale;
+
+            auto& level_of_detail = m_instance_levels_of_detail[ids[i]];
+            level_of_detail = distance > 0.0f
+                ? select_level_of_detail(levels, level_of_detail, projection_scale * scale / distance, m_frame.level_of_detail_threshold)
+                : 0;
+
+            auto const& mesh = levels[level_of_detail].mesh;
+            auto const& material = instance.material != nullptr ? *instance.material : model.material();
+            m_scratch_models.emplace_back(mesh, material, &m_frame_arena);
+            statistics.submitted_triangles += mesh.triangles().size();
+        }
+
+        // Projection, the perspective divide and the viewport transform are
+        // fused into the vertex kernel, so they're timed as a part of this.
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            transform_model(m_scratch_models[first_scratch + i], transforms[i].model_to_viewport, viewport_size);
+        }
+
+        transform_scope.end();
+        timings.geometry += lap_milliseconds(lap_start);
+
+        {
+            ProfileScope clip_scope("clip");
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                clip_model(m_scratch_models[first_scratch + i], transforms[i].model_to_viewport, viewport_size, statistics);
+            }
+        }
+
+        timings.clip += lap_milliseconds(lap_start);
+
+        {
+            ProfileScope attributes_scope("attributes");
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                transform_attributes(m_scratch_models[first_scratch + i], transforms[i].normal);
+            }
+        }
+
+        timings.geometry += lap_milliseconds(lap_start);
+
+        {
+            ProfileScope binning_scope("binning");
+            for (std::size_t i = first_scratch; i < m_scratch_models.size(); ++i) {
+                bin_model(m_scratch_models[i], i, width, height, sample_count, statistics);
+            }
+        }
+
+        timings.binning += lap_milliseconds(lap_start);
+        };
+
+    // Splits instances sorted by model into batches.
+    auto const process_instances = [&](std::span<InstanceId const> ids) {
+        while (!ids.empty()) {
+            auto const* const model = m_frame.instances[ids.front()].model;
+
+            std::size_t count = 1;
+            while (count < ids.size() && m_frame.instances[ids[count]].model == model) {
+                ++count;
+            }
+
+            process_batch(ids.first(count));
+            ids = ids.subspan(count);
+        }
+        };
+
+    auto const rasterize_tiles = [&](bool first_pass, bool last_pass) {
+        RasterContext const context = {
             projection_to_camera_transform,
             viewport_to_projection_transform,
-            depth_buffer,
+            width,
+            height,
+            sample_count,
+            first_pass,
+            last_pass
+        };
+
+        m_thread_pool->parallel_for(m_tile_bins.size(), [&](std::size_t tile_index) {
+            rasterize_tile(tile_index, context);
+            });
+
+        for (auto& bin : m_tile_bins) {
+            bin.clear();
+        }
+
+        timings.raster += lap_milliseconds(lap_start);
+        };
+
+    auto const is_instance_occluded = [&](Instance const& instance) {
+        auto const bounds = calculate_instance_bounds(
+            instance.model->mesh().bounding_sphere(),
+            scene_to_camera_transform * instance.model_to_scene_transform,
+            camera_to_projection_transform,
+            projection_to_viewport_transform,
             width,
             height
         );
+
+        return bounds.min_x > bounds.max_x || bounds.min_y > bounds.max_y ||
+            m_depth_pyramid.is_occluded(bounds.min_x, bounds.min_y, bounds.max_x, bounds.max_y, bounds.nearest_depth);
+        };
+
+    std::size_t culled_instances = 0;
+
+    if (m_frame.occlusion_culling) {
+        // Instances which were visible last frame most likely still are, so
+        // they're drawn first. The depth they leave behind decides which of
+        // the remaining instances are worth drawing at all.
+        std::pmr::vector<InstanceId> pass_instances(&m_frame_arena);
+        pass_instances.reserve(m_frustum_instances.size());
+
+        for (auto const id : m_frustum_instances) {
+            if (m_visible_instances[id]) {
+                pass_instances.push_back(id);
+            }
+        }
+
+        timings.culling += lap_milliseconds(lap_start);
+
+        process_instances(pass_instances);
+
+        rasterize_tiles(true, false);
+        m_depth_pyramid.update_coarse_levels();
+
+        pass_instances.clear();
+        for (auto const id : m_frustum_instances) {
+            if (m_visible_instances[id]) {
+                continue;
+            }
+
+            if (is_instance_occluded(m_frame.instances[id])) {
+                ++culled_instances;
+                continue;
+            }
+
+            pass_instances.push_back(id);
+        }
+
+        timings.culling += lap_milliseconds(lap_start);
+
+        process_instances(pass_instances);
+
+        rasterize_tiles(false, true);
+        m_depth_pyramid.update_coarse_levels();
+
+        for (auto const id : m_frustum_instances) {
+            m_visible_instances[id] = !is_instance_occluded(m_frame.instances[id]);
+        }
+
+        timings.culling += lap_milliseconds(lap_start);
+    } else {
+        process_instances(m_frustum_instances);
+
+        rasterize_tiles(true, true);
     }
 
-    auto* const texture = SDL_CreateTextureFromSurface(
-        m_renderer,
-        m_surface
-    );
-    SDL_RenderTexture(m_renderer, texture, nullptr, nullptr);
-    SDL_DestroyTexture(texture);
-    SDL_RenderPresent(m_renderer);
+    if (is_upscaled) {
+        upscale_frame();
+        timings.upscale = lap_milliseconds(lap_start);
+    }
+
+    for (auto const& tile_statistics : m_tile_statistics) {
+        statistics.tested_fragments += tile_statistics.tested_fragments;
+        statistics.depth_failed_fragments += tile_statistics.depth_failed_fragments;
+        statistics.depth_writes += tile_statistics.depth_writes;
+        statistics.shaded_fragments += tile_statistics.shaded_fragments;
+        statistics.covered_pixels += tile_statistics.covered_pixels;
+        statistics.culled_triangles += tile_statistics.culled_triangles;
+        statistics.expanded_pixels += tile_statistics.expanded_pixels;
+        statistics.compressed_tiles += tile_statistics.compressed_tiles;
+    }
+    statistics.visible_lights = m_frame_lights.size();
+    statistics.clustered_lights = m_light_clusters.size();
+    statistics.frustum_culled_instances = m_instance_hierarchy.size() - m_frustum_instances.size();
+    statistics.culled_instances = culled_instances;
+    statistics.resolution_scale = static_cast<double>(width) / m_framebuffer.width;
+    statistics.overdraw = statistics.covered_pixels > 0
+        ? static_cast<double>(statistics.depth_writes) / statistics.covered_pixels
+        : 0.0;
+    m_frame_statistics = statistics;
+
+    if (Profiler::instance().is_enabled()) {
+        record_statistics(statistics);
+    }
+
+    // Scratch models point into the arena, so they have to go first.
+    m_scratch_models.clear();
+    m_frame_arena.reset();
+
+    // Presenting adds to the total once it's done.
+    timings.total = m_frame_timings.begin + std::chrono::duration<double, std::milli>(Clock::now() - frame_start).count();
+    m_frame_timings = timings;
+}
 
-    SDL_DestroySurface(m_surface);
-    m_surface = nullptr;
+// Instances switch to a coarser level only once its error projects well
+// within the threshold, so they don't flicker between two levels while
+// their size hovers around it.
+static constexpr float LEVEL_OF_DETAIL_HYSTERESIS = 0.75f;
 
-    m_models.clear();
+std::size_t select_level_of_detail(
+    std::vector<LevelOfDetail> const& levels,
+    std::size_t current_level,
+    float pixels_per_unit,
+    float threshold
+) {
+    auto const coarsest_level_within = [&](float pixels) {
+        std::size_t level = 0;
+        while (level + 1 < levels.size() && levels[level + 1].error * pixels_per_unit <= pixels) {
+            ++level;
+        }
+        return level;
+        };
+
+    current_level = std::min(current_level, levels.size() - 1);
+
+    // Errors grow with every level, so this only ever refines.
+    if (levels[current_level].error * pixels_per_unit > threshold) {
+        return coarsest_level_within(threshold);
+    }
+
+    return std::max(current_level, coarsest_level_within(threshold * LEVEL_OF_DETAIL_HYSTERESIS));
+}
+
+int calculate_sample_count(Multisampling multisampling) {
+    switch (multisampling) {
+    case Multisampling::X4:
+        return 4;
+
+    case Multisampling::X8:
+        return 8;
+
+    default:
+        return 1;
+    }
+}
+
+double lap_milliseconds(Clock::time_point& since) {
+    auto const now = Clock::now();
+    auto const elapsed = std::chrono::duration<double, std::milli>(now - since).count();
+    since = now;
+    return elapsed;
+}
+
+void record_statistics(FrameStatistics const& statistics) {
+    auto& profiler = Profiler::instance();
+
+    profiler.record_counter("submitted triangles", static_cast<double>(statistics.submitted_triangles));
+    profiler.record_counter("rejected triangles", static_cast<double>(statistics.rejected_triangles));
+    profiler.record_counter("accepted triangles", static_cast<double>(statistics.accepted_triangles));
+    profiler.record_counter("clipped triangles", static_cast<double>(statistics.clipped_triangles));
+    profiler.record_counter("back faces", static_cast<double>(statistics.back_faces));
+    profiler.record_counter("culled triangles", static_cast<double>(statistics.culled_triangles));
+    profiler.record_counter("tested fragments", static_cast<double>(statistics.tested_fragments));
+    profiler.record_counter("depth failed fragments", static_cast<double>(statistics.depth_failed_fragments));
+    profiler.record_counter("shaded fragments", static_cast<double>(statistics.shaded_fragments));
+    profiler.record_counter("overdraw", statistics.overdraw);
+    profiler.record_counter("resolution scale", statistics.resolution_scale);
+    profiler.record_counter("expanded pixels", static_cast<double>(statistics.expanded_pixels));
 }
 
 glm::mat4 calculate_scene_to_camera_transform(Camera const& camera) {
@@ -90,8 +689,8 @@ glm::mat4 calculate_scene_to_camera_transform(Camera const& camera) {
 
 glm::mat4 calculate_camera_to_projection_transform(Camera const& camera, float aspect_ratio) {
     auto const half_tan = std::tan(to_radians(camera.vfov) * 0.5f);
-    auto const z_near = 0.01f;
-    auto const z_far = 1000.0f;
+    auto const z_near = Z_NEAR;
+    auto const z_far = Z_FAR;
 
     return {
         1 / (half_tan * aspect_ratio), 0, 0, 0,
@@ -110,193 +709,266 @@ glm::mat4 calculate_projection_to_viewport_transform(int width, int height) {
     };
 }
 
-void RenderSystem::transform_model(ScratchModel& scratch, glm::mat4 const& model_to_camera_transform) {
-    for (auto& vertex : scratch.vertices) {
-        vertex = model_to_camera_transform * vertex;
+InstanceBounds calculate_instance_bounds(
+    BoundingSphere const& sphere,
+    glm::mat4 const& model_to_camera_transform,
+    glm::mat4 const& camera_to_projection_transform,
+    glm::mat4 const& projection_to_viewport_transform,
+    int width,
+    int height
+) {
+    auto const center = glm::vec3(model_to_camera_transform * glm::vec4(sphere.center, 1.0f));
+    auto const scale = std::max({
+        glm::length(glm::vec3(model_to_camera_transform[0])),
+        glm::length(glm::vec3(model_to_camera_transform[1])),
+        glm::length(glm::vec3(model_to_camera_transform[2]))
+        });
+    auto const radius = sphere.radius * scale;
+
+    // Bounds reaching behind the near plane can't be projected, the instance
+    // covers the whole screen as far as culling is concerned.
+    auto const nearest_z = center.z - radius;
+    if (nearest_z <= Z_NEAR) {
+        return { 0, 0, width - 1, height - 1, std::numeric_limits<float>::infinity() };
     }
 
-    for (auto& normals : scratch.triangle_normals) {
-        for (auto& normal : normals) {
-            normal = glm::transpose(glm::inverse(glm::mat3(model_to_camera_transform))) * normal;
-        }
+    // The corners of the box around the sphere bound its projection.
+    auto min = glm::vec2(std::numeric_limits<float>::infinity());
+    auto max = glm::vec2(-std::numeric_limits<float>::infinity());
+    for (int corner = 0; corner < 8; ++corner) {
+        auto const offset = glm::vec3(
+            corner & 1 ? radius : -radius,
+            corner & 2 ? radius : -radius,
+            corner & 4 ? radius : -radius
+        );
+
+        auto const clip_position = camera_to_projection_transform * glm::vec4(center + offset, 1.0f);
+        auto const normalized_position = glm::vec3(clip_position) / clip_position.w;
+        auto const viewport_position = glm::vec2(projection_to_viewport_transform * glm::vec4(normalized_position, 1.0f));
+
+        min = glm::min(min, viewport_position);
+        max = glm::max(max, viewport_position);
     }
-}
 
-void RenderSystem::project_model(ScratchModel& scratch, glm::mat4 const& camera_to_projection_transform) {
-    for (auto& vertex : scratch.vertices) {
-        vertex = camera_to_projection_transform * vertex;
+    // Depth is stored before the perspective divide, see setup_triangle.
+    auto const nearest_depth = (camera_to_projection_transform * glm::vec4(0.0f, 0.0f, nearest_z, 1.0f)).z;
+
+    if (max.x < 0.0f || max.y < 0.0f || min.x >= width || min.y >= height) {
+        return { 0, 0, -1, -1, nearest_depth };
     }
+
+    return {
+        std::max(static_cast<int>(std::floor(min.x)), 0),
+        std::max(static_cast<int>(std::floor(min.y)), 0),
+        std::min(static_cast<int>(std::ceil(max.x)), width - 1),
+        std::min(static_cast<int>(std::ceil(max.y)), height - 1),
+        nearest_depth
+    };
 }
 
-void RenderSystem::clip_model(ScratchModel& scratch) {
-    auto& vertices = scratch.vertices;
-    auto& normals = scratch.triangle_normals;
-    auto& triangles = scratch.triangles;
+void RenderSystem::transform_model(
+    ScratchModel& scratch,
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size
+) {
+    m_vertex_kernel(
+        model_to_viewport_transform,
+        viewport_size,
+        scratch.mesh.positions(),
+        { scratch.x.data(), scratch.y.data(), scratch.z.data(), scratch.inv_w.data() },
+        scratch.outcodes.data()
+    );
+}
 
-    auto clip_distance = [](glm::vec4 const& v, ClipPlane p) -> float {
-        switch (p) {
-        case ClipPlane::LEFT:   return v.x + v.w;
-        case ClipPlane::RIGHT:  return v.w - v.x;
-        case ClipPlane::BOTTOM: return v.y + v.w;
-        case ClipPlane::TOP:    return v.w - v.y;
-        case ClipPlane::NEAR:   return v.z + v.w;
-        case ClipPlane::FAR:    return v.w - v.z;
-        }
-        return 0.f;
-        };
+static constexpr std::uint16_t FRUSTUM_OUTCODES =
+    outcode_bit(ClipPlane::LEFT) | outcode_bit(ClipPlane::RIGHT) |
+    outcode_bit(ClipPlane::BOTTOM) | outcode_bit(ClipPlane::TOP) |
+    outcode_bit(ClipPlane::NEAR) | outcode_bit(ClipPlane::FAR);
+
+static constexpr std::uint16_t CLIPPED_OUTCODES =
+    outcode_bit(ClipPlane::GUARD_BAND_LEFT) | outcode_bit(ClipPlane::GUARD_BAND_RIGHT) |
+    outcode_bit(ClipPlane::GUARD_BAND_BOTTOM) | outcode_bit(ClipPlane::GUARD_BAND_TOP) |
+    outcode_bit(ClipPlane::NEAR) | outcode_bit(ClipPlane::FAR);
+
+// Convex polygon produced by clipping a single triangle. Every plane can
+// add at most one vertex, so it never outgrows a triangle plus one vertex
+// per clipping plane. Positions are kept in homogeneous viewport space and
+// normals in model space. Texture coordinates are zero for untextured models.
+struct ClipPolygon {
+    static constexpr std::size_t CAPACITY = 3 + 6;
+
+    // Marks vertices produced by clipping, which aren't in the scratch
+    // model until the polygon gets triangulated.
+    static constexpr VertexIndex NEW_VERTEX = ~VertexIndex(0);
+
+    std::array<VertexIndex, CAPACITY> indices;
+    std::array<glm::vec4, CAPACITY> positions;
+    std::array<glm::vec3, CAPACITY> normals;
+    std::array<glm::vec2, CAPACITY> texture_coordinates;
+    std::size_t size = 0;
+
+    void push_back(VertexIndex index, glm::vec4 const& position, glm::vec3 const& normal, glm::vec2 const& vertex_texture_coordinates) {
+        indices[size] = index;
+        positions[size] = position;
+        normals[size] = normal;
+        texture_coordinates[size] = vertex_texture_coordinates;
+        ++size;
+    }
+};
 
-    std::array<ClipPlane, 6> planes = {
-        ClipPlane::LEFT, ClipPlane::RIGHT,
-        ClipPlane::BOTTOM, ClipPlane::TOP,
-        ClipPlane::NEAR, ClipPlane::FAR
-    };
+void RenderSystem::clip_model(
+    ScratchModel& scratch,
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    FrameStatistics& statistics
+) {
+    auto const& mesh = scratch.mesh;
+    auto const& positions = mesh.positions();
+    auto const& outcodes = scratch.outcodes;
+    auto const is_textured = !scratch.texture_coordinates.empty();
+
+    for (auto const& triangle : mesh.triangles()) {
+        auto const outcode0 = outcodes[triangle[0]];
+        auto const outcode1 = outcodes[triangle[1]];
+        auto const outcode2 = outcodes[triangle[2]];
+
+        if ((outcode0 & outcode1 & outcode2 & FRUSTUM_OUTCODES) != 0) {
+            ++statistics.rejected_triangles;
+            continue;
+        }
 
-    std::vector<std::array<std::size_t, 3>> clipped_triangles;
-    clipped_triangles.reserve(triangles.size() * 2);
+        auto const crossed_planes = (outcode0 | outcode1 | outcode2) & CLIPPED_OUTCODES;
+        if (crossed_planes == 0) {
+            ++statistics.accepted_triangles;
+            scratch.triangles.push_back(triangle);
+            continue;
+        }
 
-    std::vector<std::array<glm::vec3, 3>> clipped_normals;
-    clipped_normals.reserve(triangles.size() * 2);
+        ++statistics.clipped_triangles;
 
-    for (std::size_t i = 0; i < triangles.size(); ++i) {
-        auto const triangle = triangles[i];
-        auto const normal = normals[i];
+        // The vertex stage only keeps screen space positions, so the few
+        // vertices that need clipping are transformed again.
+        ClipPolygon polygon;
+        for (auto const index : triangle) {
+            auto const position = glm::vec4(positions.x[index], positions.y[index], positions.z[index], 1.0f);
+            auto const texture_coordinates = is_textured ? mesh.texture_coordinates()[index] : glm::vec2(0.0f);
+            polygon.push_back(index, model_to_viewport_transform * position, mesh.normals()[index], texture_coordinates);
+        }
 
-        std::vector<std::size_t> polygon = { triangle[0], triangle[1], triangle[2] };
-        std::vector<glm::vec3> polygon_normals = { normal[0], normal[1], normal[2] };
+        for (int p = ClipPlane::LEFT; p <= ClipPlane::GUARD_BAND_TOP; ++p) {
+            auto const plane = static_cast<ClipPlane>(p);
+            if ((crossed_planes & outcode_bit(plane)) == 0) {
+                continue;
+            }
 
-        for (ClipPlane p : planes) {
-            if (polygon.empty()) break;
+            ClipPolygon next_polygon;
 
-            std::vector<std::size_t> next_polygon;
-            next_polygon.reserve(polygon.size() + 3);
+            for (std::size_t j = 0; j < polygon.size; ++j) {
+                auto const k = (j + 1) % polygon.size;
 
-            std::vector<glm::vec3> next_polygon_normals;
-            next_polygon_normals.reserve(polygon.size() + 3);
+                auto const& v0 = polygon.positions[j];
+                auto const& v1 = polygon.positions[k];
 
-            for (std::size_t i = 0; i < polygon.size(); ++i) {
-                auto const i0 = polygon[i];
-                auto const i1 = polygon[(i + 1) % polygon.size()];
+                auto const& n0 = polygon.normals[j];
+                auto const& n1 = polygon.normals[k];
 
-                auto const& n0 = polygon_normals[i];
-                auto const& n1 = polygon_normals[(i + 1) % polygon.size()];
+                auto const& uv0 = polygon.texture_coordinates[j];
+                auto const& uv1 = polygon.texture_coordinates[k];
 
-                auto const d0 = clip_distance(vertices[i0], p);
-                auto const d1 = clip_distance(vertices[i1], p);
+                auto const d0 = calculate_clip_distance(v0, plane, viewport_size);
+                auto const d1 = calculate_clip_distance(v1, plane, viewport_size);
 
                 auto const in0 = d0 >= 0.f;
                 auto const in1 = d1 >= 0.f;
 
                 if (in0) {
-                    next_polygon.push_back(i0);
-                    next_polygon_normals.push_back(n0);
+                    next_polygon.push_back(polygon.indices[j], v0, n0, uv0);
                 }
 
                 if (in0 ^ in1) {
                     float t = d0 / (d0 - d1);
-
-                    auto const mixed_vertex = glm::mix(vertices[i0], vertices[i1], t);
-                    auto const mixed_normal = glm::mix(n0, n1, t);
-
-                    vertices.push_back(mixed_vertex);
-                    next_polygon.push_back(vertices.size() - 1);
-                    next_polygon_normals.push_back(mixed_normal);
+                    next_polygon.push_back(ClipPolygon::NEW_VERTEX, glm::mix(v0, v1, t), glm::mix(n0, n1, t), glm::mix(uv0, uv1, t));
                 }
             }
-            polygon.swap(next_polygon);
-            polygon_normals.swap(next_polygon_normals);
-        }
 
-        if (polygon.size() < 3) {
-            continue;
+            polygon = next_polygon;
+            if (polygon.size < 3) {
+                break;
+            }
         }
 
-        for (std::size_t i = 1; i + 1 < polygon.size(); ++i) {
-            clipped_triangles.push_back({ polygon[0], polygon[i], polygon[i + 1] });
-            clipped_normals.push_back({
-                    polygon_normals[0],
-                    polygon_normals[i],
-                    polygon_normals[i + 1],
-                });
+        if (polygon.size < 3) {
+            continue;
         }
-    }
 
-    triangles.swap(clipped_triangles);
-    normals.swap(clipped_normals);
-}
+        for (std::size_t j = 0; j < polygon.size; ++j) {
+            if (polygon.indices[j] != ClipPolygon::NEW_VERTEX) {
+                continue;
+            }
 
-void RenderSystem::normalize_model(ScratchModel& scratch) {
-    for (std::size_t i = 0; i < scratch.vertices.size(); ++i) {
-        auto& vertex = scratch.vertices[i];
+            auto const& position = polygon.positions[j];
+            auto const inv_w = 1.0f / position.w;
+            polygon.indices[j] = scratch.push_vertex(
+                glm::vec4(glm::vec3(position) * inv_w, inv_w),
+                polygon.normals[j],
+                polygon.texture_coordinates[j]
+            );
+        }
 
-        auto const inv_w = 1 / vertex.w;
-        vertex *= inv_w;
-        vertex.w = inv_w;
+        for (std::size_t j = 1; j + 1 < polygon.size; ++j) {
+            scratch.triangles.push_back({ polygon.indices[0], polygon.indices[j], polygon.indices[j + 1] });
+        }
     }
+}
 
-    for (std::size_t i = 0; i < scratch.triangles.size(); ++i) {
-        auto& triangle = scratch.triangles[i];
-        auto& normals = scratch.triangle_normals[i];
+// Every vertex is transformed once, no matter how many triangles share it.
+void RenderSystem::transform_attributes(ScratchModel& scratch, glm::mat3 const& normal_transform) {
+    auto const mesh_normals = scratch.mesh.normals();
 
-        for (std::size_t j = 0; j < normals.size(); ++j) {
-            normals[j] *= scratch.vertices[triangle[j]].w;
-        }
+    for (std::size_t i = 0; i < scratch.normals.size(); ++i) {
+        auto const& normal = i < mesh_normals.size() ? mesh_normals[i] : scratch.normals[i];
+        scratch.normals[i] = normal_transform * normal * scratch.inv_w[i];
     }
-}
 
-void RenderSystem::viewport_model(ScratchModel& scratch, glm::mat4 const& projection_to_viewport_transform) {
-    for (auto& vertex : scratch.vertices) {
-        auto const inv_w = vertex.w;
+    auto const mesh_texture_coordinates = scratch.mesh.texture_coordinates();
 
-        vertex = projection_to_viewport_transform * glm::vec4(glm::vec3(vertex), 1.0f);
-        vertex.w = inv_w;
+    for (std::size_t i = 0; i < scratch.texture_coordinates.size(); ++i) {
+        auto const& texture_coordinates = i < mesh_texture_coordinates.size() ? mesh_texture_coordinates[i] : scratch.texture_coordinates[i];
+        scratch.texture_coordinates[i] = texture_coordinates * scratch.inv_w[i];
     }
 }
 
-struct BoundingBox {
+struct ScreenBoundingBox {
     int min_x;
     int min_y;
     int max_x;
     int max_y;
 };
 
-static BoundingBox calculate_bounding_box(
-    glm::vec4 const& v0,
-    glm::vec4 const& v1,
-    glm::vec4 const& v2,
-    int width,
-    int height
-);
-
-static glm::vec3 calculate_barycentric_coordinates(
-    glm::vec2 const& a,
-    glm::vec2 const& b,
-    glm::vec2 const& c,
-    glm::vec2 const& point
-);
-
-static float calculate_depth(
-    glm::vec4 const& v0,
-    glm::vec4 const& v1,
-    glm::vec4 const& v2,
-    glm::vec3 const& lambda
-);
+static ScreenBoundingBox calculate_screen_bounding_box(TriangleSetup const& setup, int width, int height, int sample_count);
 
-static bool is_back_face(glm::vec4 v0, glm::vec4 v1, glm::vec4 v2);
+// Camera space position and unit normal of a fragment.
+struct SurfacePoint {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
 
-static glm::vec3 calculate_illumination(
+static SurfacePoint calculate_surface_point(
     glm::vec4 const& v0,
     glm::vec4 const& v1,
     glm::vec4 const& v2,
-    Material const& material,
     glm::vec3 const& n0,
     glm::vec3 const& n1,
     glm::vec3 const& n2,
     glm::vec3 const& lambda,
     glm::mat4 const& projection_to_camera_transform,
-    glm::mat4 const& viewport_to_projection_transform,
-    Light const& light
+    glm::mat4 const& viewport_to_projection_transform
 );
 
+static glm::vec3 calculate_illumination(SurfacePoint const& point, Material const& material, Light const& light);
+
+static glm::vec2 calculate_texture_coordinates(ScratchModel const& scratch, Triangle const& triangle, glm::vec3 const& lambda);
+
 template <typename T>
 static T interpolate_barycentrically(
     T const& a,
@@ -305,144 +977,664 @@ static T interpolate_barycentrically(
     glm::vec3 const& lambda
 );
 
-void RenderSystem::rasterize_model(
+void RenderSystem::bin_model(
     ScratchModel& scratch,
-    glm::mat4 const& projection_to_camera_transform,
-    glm::mat4 const& viewport_to_projection_transform,
-    std::vector<float>& depth_buffer,
+    std::size_t model_index,
     int width,
-    int height
+    int height,
+    int sample_count,
+    FrameStatistics& statistics
 ) {
-    auto const& vertices = scratch.vertices;
+    scratch.triangle_setups.resize(scratch.triangles.size());
 
     for (std::size_t i = 0; i < scratch.triangles.size(); ++i) {
         auto const& triangle = scratch.triangles[i];
 
-        if (is_back_face(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]])) {
+        auto const v0 = scratch.vertex(triangle[0]);
+        auto const v1 = scratch.vertex(triangle[1]);
+        auto const v2 = scratch.vertex(triangle[2]);
+
+        auto& setup = scratch.triangle_setups[i];
+        if (!setup_triangle(v0, v1, v2, setup)) {
+            ++statistics.back_faces;
             continue;
         }
 
-        auto const bounding_box = calculate_bounding_box(vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]], width, height);
+        // Slivers between pixel centers and triangles in the guard band
+        // cover no pixels.
+        auto const bounding_box = calculate_screen_bounding_box(setup, width, height, sample_count);
+        if (bounding_box.min_x > bounding_box.max_x || bounding_box.min_y > bounding_box.max_y) {
+            continue;
+        }
 
-        for (int y = bounding_box.min_y; y <= bounding_box.max_y; ++y) {
-            if (y < 0 || y >= height) {
-                continue;
+        auto const min_column = bounding_box.min_x / TILE_SIZE;
+        auto const min_row = bounding_box.min_y / TILE_SIZE;
+        auto const max_column = std::min(bounding_box.max_x / TILE_SIZE, m_tile_columns - 1);
+        auto const max_row = std::min(bounding_box.max_y / TILE_SIZE, m_tile_rows - 1);
+
+        for (int row = min_row; row <= max_row; ++row) {
+            for (int column = min_column; column <= max_column; ++column) {
+                auto const tile_index = static_cast<std::size_t>(row) * m_tile_columns + column;
+                m_tile_bins[tile_index].push_back({ model_index, i });
             }
+        }
+    }
+}
+
+Tile RenderSystem::calculate_tile(std::size_t tile_index, int width, int height) const {
+    auto const column = static_cast<int>(tile_index % m_tile_columns);
+    auto const row = static_cast<int>(tile_index / m_tile_columns);
+
+    return {
+        column * TILE_SIZE,
+        row * TILE_SIZE,
+        std::min((column + 1) * TILE_SIZE, width) - 1,
+        std::min((row + 1) * TILE_SIZE, height) - 1
+    };
+}
+
+static glm::vec3 const CLEAR_COLOR = glm::vec3(1.0f);
+
+void RenderSystem::clear_tile(std::size_t tile_index, Tile const& tile, RasterContext const& context) {
+    auto const plane_size = static_cast<std::size_t>(context.width) * context.height;
+
+    for (int y = tile.min_y; y <= tile.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+
+        std::fill_n(m_color_buffer.red.data() + row_offset + tile.min_x, tile.max_x - tile.min_x + 1, CLEAR_COLOR.r);
+        std::fill_n(m_color_buffer.green.data() + row_offset + tile.min_x, tile.max_x - tile.min_x + 1, CLEAR_COLOR.g);
+        std::fill_n(m_color_buffer.blue.data() + row_offset + tile.min_x, tile.max_x - tile.min_x + 1, CLEAR_COLOR.b);
+
+        auto* const depth_row = m_depth_buffer.data() + row_offset;
+        std::fill(depth_row + tile.min_x, depth_row + tile.max_x + 1, -std::numeric_limits<float>::infinity());
+
+        for (int sample = 0; context.sample_count > 1 && sample < context.sample_count; ++sample) {
+            auto* const sample_depth_row = m_sample_depths.data() + sample * plane_size + row_offset;
+            std::fill(sample_depth_row + tile.min_x, sample_depth_row + tile.max_x + 1, -std::numeric_limits<float>::infinity());
+        }
+
+        if (m_frame.shading_mode == ShadingMode::VISIBILITY) {
+            auto* const visibility_row = m_visibility_buffer.data() + row_offset;
+            std::fill(
+                visibility_row + tile.min_x,
+                visibility_row + tile.max_x + 1,
+                VisibilityRecord{ VisibilityRecord::EMPTY, VisibilityRecord::EMPTY, 0.0f, 0.0f }
+            );
+        }
+    }
+
+    if (context.sample_count > 1) {
+        m_tile_samples[tile_index].expanded_rows.fill(0);
+    }
+}
+
+void RenderSystem::rasterize_tile(std::size_t tile_index, RasterContext const& context) {
+    ProfileScope profile_scope("raster tile");
+    auto const tile = calculate_tile(tile_index, context.width, context.height);
+
+    if (context.first_pass) {
+        clear_tile(tile_index, tile, context);
+    }
 
-            for (int x = bounding_box.min_x; x <= bounding_box.max_x; ++x) {
-                if (x < 0 || x >= width) {
-                    continue;
+    auto statistics = m_tile_statistics[tile_index];
+
+    if (m_frame.shading_mode == ShadingMode::VISIBILITY) {
+        for (auto const& reference : m_tile_bins[tile_index]) {
+            rasterize_triangle_visibility(reference.model, reference.triangle, tile, context, statistics);
+        }
+
+        if (context.last_pass) {
+            resolve_visibility_tile(tile, context, statistics);
+        }
+    } else if (context.sample_count > 1) {
+        auto& samples = m_tile_samples[tile_index];
+        for (auto const& reference : m_tile_bins[tile_index]) {
+            rasterize_triangle_multisampled(m_scratch_models[reference.model], reference.triangle, tile, samples, context, statistics);
+        }
+
+        resolve_sample_depths(tile, context, statistics);
+        if (context.last_pass) {
+            resolve_samples(tile, samples, context, statistics);
+        }
+    } else {
+        for (auto const& reference : m_tile_bins[tile_index]) {
+            rasterize_triangle(m_scratch_models[reference.model], reference.triangle, tile, context, statistics);
+        }
+
+        for (int y = tile.min_y; context.last_pass && y <= tile.max_y; ++y) {
+            auto const* const depth_row = m_depth_buffer.data() + static_cast<std::size_t>(y) * context.width;
+            statistics.covered_pixels += std::count_if(
+                depth_row + tile.min_x,
+                depth_row + tile.max_x + 1,
+                [](float depth) { return depth != -std::numeric_limits<float>::infinity(); }
+            );
+        }
+    }
+
+    if (context.last_pass) {
+        resolve_tile(tile, context.width);
+    }
+
+    if (m_frame.occlusion_culling) {
+        m_depth_pyramid.update_tile(m_depth_buffer.data(), tile.min_x, tile.min_y, tile.max_x, tile.max_y);
+    }
+
+    m_tile_statistics[tile_index] = statistics;
+}
+
+// Tests a triangle against the depth left behind by the first pass, which
+// is conservative for the second pass since depth only ever gets nearer.
+bool RenderSystem::is_triangle_occluded(
+    TriangleSetup const& setup,
+    Tile const& bounds,
+    RasterContext const& context,
+    FrameStatistics& statistics
+) const {
+    if (context.first_pass || bounds.min_x > bounds.max_x || bounds.min_y > bounds.max_y) {
+        return false;
+    }
+
+    if (!m_depth_pyramid.is_occluded(bounds.min_x, bounds.min_y, bounds.max_x, bounds.max_y, setup.nearest_depth)) {
+        return false;
+    }
+
+    ++statistics.culled_triangles;
+    return true;
+}
+
+static Tile calculate_triangle_bounds(TriangleSetup const& setup, Tile const& tile, RasterContext const& context);
+
+void RenderSystem::rasterize_triangle(
+    ScratchModel const& scratch,
+    std::size_t triangle_index,
+    Tile const& tile,
+    RasterContext const& context,
+    FrameStatistics& statistics
+) {
+    auto const& setup = scratch.triangle_setups[triangle_index];
+    auto const bounds = calculate_triangle_bounds(setup, tile, context);
+
+    if (is_triangle_occluded(setup, bounds, context, statistics)) {
+        return;
+    }
+
+    std::array<float, MAX_ROW_PIXELS> depths;
+
+    for (int y = bounds.min_y; y <= bounds.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+        auto* const depth_row = m_depth_buffer.data() + row_offset;
+        auto* const red_row = m_color_buffer.red.data() + row_offset;
+        auto* const green_row = m_color_buffer.green.data() + row_offset;
+        auto* const blue_row = m_color_buffer.blue.data() + row_offset;
+
+        std::uint64_t coverage;
+        auto mask = m_row_kernel(setup, bounds.min_x, y, bounds.max_x - bounds.min_x + 1, depth_row + bounds.min_x, depths.data(), coverage);
+        statistics.tested_fragments += std::popcount(coverage);
+        statistics.depth_failed_fragments += std::popcount(coverage & ~mask);
+
+        while (mask != 0) {
+            auto const i = std::countr_zero(mask);
+            mask &= mask - 1;
+
+            auto const x = bounds.min_x + i;
+            auto const lambda = setup.barycentric_coordinates(x + 0.5f, y + 0.5f);
+
+            auto const color = shade_fragment(scratch, triangle_index, lambda, x, y, context);
+
+            depth_row[x] = depths[i];
+            red_row[x] = color.r;
+            green_row[x] = color.g;
+            blue_row[x] = color.b;
+
+            ++statistics.depth_writes;
+            ++statistics.shaded_fragments;
+        }
+    }
+}
+
+// Every sample is scanned on its own, by the row kernel with the setup
+// offset to it, against a depth plane of its own. Pixels with any sample
+// passing the depth test are then shaded once, and the color goes to the
+// samples which passed.
+void RenderSystem::rasterize_triangle_multisampled(
+    ScratchModel const& scratch,
+    std::size_t triangle_index,
+    Tile const& tile,
+    TileSamples& samples,
+    RasterContext const& context,
+    FrameStatistics& statistics
+) {
+    auto const& setup = scratch.triangle_setups[triangle_index];
+    auto const bounds = calculate_triangle_bounds(setup, tile, context);
+
+    if (is_triangle_occluded(setup, bounds, context, statistics)) {
+        return;
+    }
+
+    auto const sample_count = context.sample_count;
+    auto const pattern = sample_pattern(sample_count);
+    auto const all_samples = (1u << sample_count) - 1;
+    auto const plane_size = static_cast<std::size_t>(context.width) * context.height;
+    auto const tile_sample_count = static_cast<std::size_t>(TILE_SIZE) * TILE_SIZE * sample_count;
+
+    std::array<TriangleSetup, MAX_SAMPLES> sample_setups;
+    for (int sample = 0; sample < sample_count; ++sample) {
+        sample_setups[sample] = offset_triangle_setup(setup, pattern[sample]);
+    }
+
+    std::array<std::array<float, MAX_ROW_PIXELS>, MAX_SAMPLES> depths;
+    std::array<std::uint64_t, MAX_SAMPLES> masks;
+    std::array<std::uint64_t, MAX_SAMPLES> coverages;
+
+    for (int y = bounds.min_y; y <= bounds.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+        auto* const red_row = m_color_buffer.red.data() + row_offset;
+        auto* const green_row = m_color_buffer.green.data() + row_offset;
+        auto* const blue_row = m_color_buffer.blue.data() + row_offset;
+        auto& expanded_row = samples.expanded_rows[y - tile.min_y];
+
+        std::uint64_t coverage = 0;
+        std::uint64_t mask = 0;
+        for (int sample = 0; sample < sample_count; ++sample) {
+            auto const* const depth_row = m_sample_depths.data() + sample * plane_size + row_offset;
+            masks[sample] = m_row_kernel(
+                sample_setups[sample],
+                bounds.min_x,
+                y,
+                bounds.max_x - bounds.min_x + 1,
+                depth_row + bounds.min_x,
+                depths[sample].data(),
+                coverages[sample]
+            );
+
+            coverage |= coverages[sample];
+            mask |= masks[sample];
+        }
+
+        statistics.tested_fragments += std::popcount(coverage);
+        statistics.depth_failed_fragments += std::popcount(coverage & ~mask);
+
+        while (mask != 0) {
+            auto const i = std::countr_zero(mask);
+            mask &= mask - 1;
+
+            auto const x = bounds.min_x + i;
+
+            unsigned covered_samples = 0;
+            unsigned passed_samples = 0;
+            for (int sample = 0; sample < sample_count; ++sample) {
+                covered_samples |= static_cast<unsigned>((coverages[sample] >> i) & 1) << sample;
+                passed_samples |= static_cast<unsigned>((masks[sample] >> i) & 1) << sample;
+            }
+
+            // Partially covered pixels are shaded at their first covered
+            // sample rather than their center, which may lie outside the
+            // triangle, so attributes are never extrapolated.
+            auto position = glm::vec2(x + 0.5f, y + 0.5f);
+            if (covered_samples != all_samples) {
+                auto const& offset = pattern[std::countr_zero(covered_samples)];
+                position += glm::vec2(static_cast<float>(offset.x), static_cast<float>(offset.y)) / static_cast<float>(SUBPIXEL_SCALE);
+            }
+
+            auto const lambda = setup.barycentric_coordinates(position.x, position.y);
+            auto const color = shade_fragment(scratch, triangle_index, lambda, x, y, context);
+
+            for (auto remaining = passed_samples; remaining != 0; remaining &= remaining - 1) {
+                auto const sample = std::countr_zero(remaining);
+                m_sample_depths[sample * plane_size + row_offset + x] = depths[sample][i];
+            }
+
+            // Covering every sample makes the pixel uniform again, otherwise
+            // its samples have to be expanded before some of them change.
+            auto const pixel_bit = std::uint64_t(1) << (x - tile.min_x);
+            if (passed_samples == all_samples) {
+                red_row[x] = color.r;
+                green_row[x] = color.g;
+                blue_row[x] = color.b;
+                expanded_row &= ~pixel_bit;
+            } else {
+                if (samples.colors.size() < tile_sample_count) {
+                    samples.colors.resize(tile_sample_count);
+                }
+
+                auto* const pixel_samples = samples.colors.data() +
+                    (static_cast<std::size_t>(y - tile.min_y) * TILE_SIZE + (x - tile.min_x)) * sample_count;
+
+                if ((expanded_row & pixel_bit) == 0) {
+                    std::fill_n(pixel_samples, sample_count, glm::vec3(red_row[x], green_row[x], blue_row[x]));
+                    expanded_row |= pixel_bit;
                 }
 
-                auto const lambda = calculate_barycentric_coordinates(
-                    vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]],
-                    glm::vec2(x + 0.5f, y + 0.5f)
-                );
-
-                auto const depth = calculate_depth(
-                    vertices[triangle[0]],
-                    vertices[triangle[1]],
-                    vertices[triangle[2]],
-                    lambda
-                );
-
-                auto const depth_buffer_index = static_cast<std::size_t>(y) * width + x;
-                if (std::isnan(depth) || depth <= depth_buffer[depth_buffer_index]) {
-                    continue;
+                for (auto remaining = passed_samples; remaining != 0; remaining &= remaining - 1) {
+                    pixel_samples[std::countr_zero(remaining)] = color;
                 }
+            }
+
+            ++statistics.depth_writes;
+            ++statistics.shaded_fragments;
+        }
+    }
+}
+
+void RenderSystem::rasterize_triangle_visibility(
+    std::size_t model_index,
+    std::size_t triangle_index,
+    Tile const& tile,
+    RasterContext const& context,
+    FrameStatistics& statistics
+) {
+    auto const& scratch = m_scratch_models[model_index];
+    auto const& setup = scratch.triangle_setups[triangle_index];
+    auto const bounds = calculate_triangle_bounds(setup, tile, context);
 
-                auto const& triangle_normals = scratch.triangle_normals[i];
-                auto const& material = scratch.model.material();
+    if (is_triangle_occluded(setup, bounds, context, statistics)) {
+        return;
+    }
+
+    std::array<float, MAX_ROW_PIXELS> depths;
+
+    for (int y = bounds.min_y; y <= bounds.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+        auto* const depth_row = m_depth_buffer.data() + row_offset;
+        auto* const visibility_row = m_visibility_buffer.data() + row_offset;
+
+        std::uint64_t coverage;
+        auto mask = m_row_kernel(setup, bounds.min_x, y, bounds.max_x - bounds.min_x + 1, depth_row + bounds.min_x, depths.data(), coverage);
+        statistics.tested_fragments += std::popcount(coverage);
+        statistics.depth_failed_fragments += std::popcount(coverage & ~mask);
+
+        while (mask != 0) {
+            auto const i = std::countr_zero(mask);
+            mask &= mask - 1;
+
+            auto const x = bounds.min_x + i;
+            auto const lambda = setup.barycentric_coordinates(x + 0.5f, y + 0.5f);
+
+            depth_row[x] = depths[i];
+            visibility_row[x] = {
+                static_cast<std::uint32_t>(model_index),
+                static_cast<std::uint32_t>(triangle_index),
+                lambda.y,
+                lambda.z
+            };
 
-                auto const illumination = calculate_illumination(
-                    vertices[triangle[0]], vertices[triangle[1]], vertices[triangle[2]],
-                    material,
-                    triangle_normals[0], triangle_normals[1], triangle_normals[2],
-                    lambda,
-                    projection_to_camera_transform,
-                    viewport_to_projection_transform,
-                    m_light
-                );
+            ++statistics.depth_writes;
+        }
+    }
+}
+
+// The depth buffer gets the farthest sample of every pixel, which is what
+// occlusion culling has to test against. Pixels count as covered once any
+// of their samples is.
+void RenderSystem::resolve_sample_depths(Tile const& tile, RasterContext const& context, FrameStatistics& statistics) {
+    auto const plane_size = static_cast<std::size_t>(context.width) * context.height;
+    auto const count = tile.max_x - tile.min_x + 1;
 
-                auto linear_color = material.color() * illumination;
-                auto const srgb_color = glm::pow(linear_color, glm::vec3(1.0f / 2.2f));
+    std::array<float, MAX_ROW_PIXELS> nearest;
 
-                depth_buffer[depth_buffer_index] = depth;
-                SDL_WriteSurfacePixelFloat(m_surface, x, y, srgb_color.r, srgb_color.g, srgb_color.b, SDL_ALPHA_OPAQUE);
+    for (int y = tile.min_y; y <= tile.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width + tile.min_x;
+        auto* const depth_row = m_depth_buffer.data() + row_offset;
+
+        std::copy_n(m_sample_depths.data() + row_offset, count, depth_row);
+        std::copy_n(m_sample_depths.data() + row_offset, count, nearest.data());
+
+        for (int sample = 1; sample < context.sample_count; ++sample) {
+            auto const* const sample_depth_row = m_sample_depths.data() + sample * plane_size + row_offset;
+            for (int i = 0; i < count; ++i) {
+                depth_row[i] = std::min(depth_row[i], sample_depth_row[i]);
+                nearest[i] = std::max(nearest[i], sample_depth_row[i]);
             }
         }
+
+        if (context.last_pass) {
+            statistics.covered_pixels += std::count_if(
+                nearest.begin(),
+                nearest.begin() + count,
+                [](float depth) { return depth != -std::numeric_limits<float>::infinity(); }
+            );
+        }
     }
 }
 
-BoundingBox calculate_bounding_box(
-    glm::vec4 const& v0,
-    glm::vec4 const& v1,
-    glm::vec4 const& v2,
+// Averages the samples of the expanded pixels into the color buffer, the
+// other pixels already hold the color all of their samples share.
+void RenderSystem::resolve_samples(Tile const& tile, TileSamples const& samples, RasterContext const& context, FrameStatistics& statistics) {
+    auto const sample_count = context.sample_count;
+    auto const sample_weight = 1.0f / static_cast<float>(sample_count);
+    auto is_compressed = true;
+
+    for (int y = tile.min_y; y <= tile.max_y; ++y) {
+        auto expanded_row = samples.expanded_rows[y - tile.min_y];
+        if (expanded_row == 0) {
+            continue;
+        }
+
+        is_compressed = false;
+        statistics.expanded_pixels += std::popcount(expanded_row);
+
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+        auto const* const sample_row = samples.colors.data() + static_cast<std::size_t>(y - tile.min_y) * TILE_SIZE * sample_count;
+
+        while (expanded_row != 0) {
+            auto const i = std::countr_zero(expanded_row);
+            expanded_row &= expanded_row - 1;
+
+            auto const* const pixel_samples = sample_row + static_cast<std::size_t>(i) * sample_count;
+            auto color = glm::vec3(0.0f);
+            for (int sample = 0; sample < sample_count; ++sample) {
+                color += pixel_samples[sample];
+            }
+            color *= sample_weight;
+
+            auto const x = tile.min_x + i;
+            m_color_buffer.red[row_offset + x] = color.r;
+            m_color_buffer.green[row_offset + x] = color.g;
+            m_color_buffer.blue[row_offset + x] = color.b;
+        }
+    }
+
+    if (is_compressed) {
+        ++statistics.compressed_tiles;
+    }
+}
+
+void RenderSystem::resolve_visibility_tile(Tile const& tile, RasterContext const& context, FrameStatistics& statistics) {
+    ProfileScope profile_scope("shade");
+    for (int y = tile.min_y; y <= tile.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * context.width;
+        auto const* const visibility_row = m_visibility_buffer.data() + row_offset;
+        auto* const red_row = m_color_buffer.red.data() + row_offset;
+        auto* const green_row = m_color_buffer.green.data() + row_offset;
+        auto* const blue_row = m_color_buffer.blue.data() + row_offset;
+
+        for (int x = tile.min_x; x <= tile.max_x; ++x) {
+            auto const& record = visibility_row[x];
+            if (record.model == VisibilityRecord::EMPTY) {
+                continue;
+            }
+
+            auto const lambda = glm::vec3(1.0f - record.beta - record.gamma, record.beta, record.gamma);
+            auto const color = shade_fragment(m_scratch_models[record.model], record.triangle, lambda, x, y, context);
+
+            red_row[x] = color.r;
+            green_row[x] = color.g;
+            blue_row[x] = color.b;
+
+            ++statistics.shaded_fragments;
+            ++statistics.covered_pixels;
+        }
+    }
+}
+
+void RenderSystem::cluster_lights(
+    glm::mat4 const& scene_to_camera_transform,
+    glm::mat4 const& camera_to_projection_transform,
+    glm::mat4 const& projection_to_viewport_transform,
     int width,
     int height
 ) {
-    auto const min_x = std::clamp(static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0, width);
-    auto const min_y = std::clamp(static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0, height);
-    auto const max_x = std::clamp(static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))), 0, width);
-    auto const max_y = std::clamp(static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))), 0, height);
+    m_frame_lights.clear();
+    m_light_clusters.reset(width, height, Z_NEAR, Z_FAR);
+
+    for (auto const& light : m_frame.lights) {
+        if (!(light.radius > 0.0f)) {
+            continue;
+        }
+
+        auto frame_light = light;
+        frame_light.position = glm::vec3(scene_to_camera_transform * glm::vec4(light.position, 1.0f));
+        auto const index = static_cast<std::uint32_t>(m_frame_lights.size());
+
+        if (std::isinf(light.radius)) {
+            m_frame_lights.push_back(frame_light);
+            m_light_clusters.add_global_light(index);
+            continue;
+        }
+
+        auto const min_z = frame_light.position.z - light.radius;
+        auto const max_z = frame_light.position.z + light.radius;
+        if (max_z <= Z_NEAR || min_z >= Z_FAR) {
+            continue;
+        }
+
+        auto const bounds = calculate_instance_bounds(
+            BoundingSphere{ frame_light.position, light.radius },
+            glm::mat4(1.0f),
+            camera_to_projection_transform,
+            projection_to_viewport_transform,
+            width,
+            height
+        );
+        if (bounds.min_x > bounds.max_x || bounds.min_y > bounds.max_y) {
+            continue;
+        }
 
-    return { min_x, min_y, max_x, max_y };
+        m_frame_lights.push_back(frame_light);
+        m_light_clusters.add_light(index, bounds.min_x, bounds.min_y, bounds.max_x, bounds.max_y, min_z, max_z);
+    }
+
+    m_light_clusters.commit();
 }
 
-glm::vec3 calculate_barycentric_coordinates(
-    glm::vec2 const& a,
-    glm::vec2 const& b,
-    glm::vec2 const& c,
-    glm::vec2 const& point
-) {
-    auto const edge = [](glm::vec2 const& a, glm::vec2 const& b, glm::vec2 const& c) {
-        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
-        };
+glm::vec3 RenderSystem::shade_fragment(
+    ScratchModel const& scratch,
+    std::size_t triangle_index,
+    glm::vec3 const& lambda,
+    int x,
+    int y,
+    RasterContext const& context
+) const {
+    auto const& triangle = scratch.triangles[triangle_index];
+    auto const& material = scratch.material;
+
+    auto const point = calculate_surface_point(
+        scratch.vertex(triangle[0]), scratch.vertex(triangle[1]), scratch.vertex(triangle[2]),
+        scratch.normals[triangle[0]], scratch.normals[triangle[1]], scratch.normals[triangle[2]],
+        lambda,
+        context.projection_to_camera_transform,
+        context.viewport_to_projection_transform
+    );
 
-    auto const area = edge(a, b, c);
-    auto const alpha = edge(point, b, c) / area;
-    auto const beta = edge(a, point, c) / area;
-    auto const gamma = edge(a, b, point) / area;
+    auto illumination = glm::vec3(0.0f);
+    for (auto const light : m_light_clusters.global_lights()) {
+        illumination += calculate_illumination(point, material, m_frame_lights[light]);
+    }
+    for (auto const light : m_light_clusters.lights(x, y, point.position.z)) {
+        illumination += calculate_illumination(point, material, m_frame_lights[light]);
+    }
 
-    if (alpha < 0 || beta < 0 || gamma < 0) {
-        return glm::vec3(std::numeric_limits<float>::quiet_NaN());
+    if (scratch.texture_coordinates.empty()) {
+        return material.color() * illumination;
     }
 
-    return { alpha, beta, gamma };
+    // The quad's derivatives are the same for all of its pixels, so they
+    // step like a GPU's, which keeps the level of detail from flickering
+    // between neighbors.
+    auto const& setup = scratch.triangle_setups[triangle_index];
+    auto const quad_x = static_cast<float>(x & ~1) + 0.5f;
+    auto const quad_y = static_cast<float>(y & ~1) + 0.5f;
+
+    auto const texture_coordinates = calculate_texture_coordinates(scratch, triangle, lambda);
+    auto const quad_texture_coordinates = calculate_texture_coordinates(scratch, triangle, setup.barycentric_coordinates(quad_x, quad_y));
+    auto const texture_coordinates_dx =
+        calculate_texture_coordinates(scratch, triangle, setup.barycentric_coordinates(quad_x + 1.0f, quad_y)) - quad_texture_coordinates;
+    auto const texture_coordinates_dy =
+        calculate_texture_coordinates(scratch, triangle, setup.barycentric_coordinates(quad_x, quad_y + 1.0f)) - quad_texture_coordinates;
+
+    auto const texel = material.texture()->sample(
+        texture_coordinates,
+        texture_coordinates_dx,
+        texture_coordinates_dy,
+        m_frame.texture_filtering
+    );
+
+    return material.color() * texel * illumination;
 }
 
-float calculate_depth(
-    glm::vec4 const& v0,
-    glm::vec4 const& v1,
-    glm::vec4 const& v2,
-    glm::vec3 const& lambda
-) {
-    auto const inv_w = interpolate_barycentrically(v0.w, v1.w, v2.w, lambda);
-    auto const reverse_z = interpolate_barycentrically(v0.z, v1.z, v2.z, lambda) / inv_w;
-    return reverse_z;
+void RenderSystem::resolve_tile(Tile const& tile, int width) {
+    ProfileScope profile_scope("resolve");
+    for (int y = tile.min_y; y <= tile.max_y; ++y) {
+        auto const row_offset = static_cast<std::size_t>(y) * width + tile.min_x;
+        auto* const color_row = m_resolve_target.pixels + static_cast<std::size_t>(y) * m_resolve_target.stride;
+
+        m_resolve_kernel(
+            m_color_buffer.red.data() + row_offset,
+            m_color_buffer.green.data() + row_offset,
+            m_color_buffer.blue.data() + row_offset,
+            tile.max_x - tile.min_x + 1,
+            m_frame.resolve_settings,
+            color_row + tile.min_x
+        );
+    }
 }
 
+void RenderSystem::upscale_frame() {
+    auto const band_count = (m_framebuffer.height + TILE_SIZE - 1) / TILE_SIZE;
 
-bool is_back_face(glm::vec4 v0, glm::vec4 v1, glm::vec4 v2) {
-    auto const direction = glm::cross(
-        glm::vec3(glm::vec2(v1), 0.0f) - glm::vec3(glm::vec2(v0), 0.0f),
-        glm::vec3(glm::vec2(v2), 0.0f) - glm::vec3(glm::vec2(v0), 0.0f)
-    ).z;
-    return direction > 0;
+    m_thread_pool->parallel_for(band_count, [&](std::size_t band) {
+        ProfileScope profile_scope("upscale");
+        auto const first_row = static_cast<int>(band) * TILE_SIZE;
+        auto const last_row = std::min(first_row + TILE_SIZE, m_framebuffer.height);
+        m_upscaler.upscale_rows(m_scaled_pixels.data(), m_resolve_target.stride, m_framebuffer, first_row, last_row);
+        });
 }
 
-static glm::vec3 calculate_illumination(
+Tile calculate_triangle_bounds(TriangleSetup const& setup, Tile const& tile, RasterContext const& context) {
+    auto const bounding_box = calculate_screen_bounding_box(setup, context.width, context.height, context.sample_count);
+
+    return {
+        std::max(bounding_box.min_x, tile.min_x),
+        std::max(bounding_box.min_y, tile.min_y),
+        std::min(bounding_box.max_x, tile.max_x),
+        std::min(bounding_box.max_y, tile.max_y)
+    };
+}
+
+// Empty, with min greater than max, if the triangle covers no pixel centers
+// on screen. Samples lie within half a pixel of their pixel's center, so
+// multisampled triangles may also cover the pixels just outside the box.
+ScreenBoundingBox calculate_screen_bounding_box(TriangleSetup const& setup, int width, int height, int sample_count) {
+    auto const margin = sample_count > 1 ? 1 : 0;
+
+    return {
+        std::max(setup.min_x - margin, 0),
+        std::max(setup.min_y - margin, 0),
+        std::min(setup.max_x + margin, width - 1),
+        std::min(setup.max_y + margin, height - 1)
+    };
+}
+
+SurfacePoint calculate_surface_point(
     glm::vec4 const& v0,
     glm::vec4 const& v1,
     glm::vec4 const& v2,
-    Material const& material,
     glm::vec3 const& n0,
     glm::vec3 const& n1,
     glm::vec3 const& n2,
     glm::vec3 const& lambda,
     glm::mat4 const& projection_to_camera_transform,
-    glm::mat4 const& viewport_to_projection_transform,
-    Light const& light
+    glm::mat4 const& viewport_to_projection_transform
 ) {
     auto const inv_w = interpolate_barycentrically(v0.w, v1.w, v2.w, lambda);
 
@@ -454,24 +1646,57 @@ static glm::vec3 calculate_illumination(
     auto const clip_position = normalized_position / viewport_position.w;
     auto const position = glm::vec3(projection_to_camera_transform * clip_position);
 
+    return { position, normal };
+}
+
+// Texture coordinates and 1 / w both interpolate linearly on screen, so
+// dividing one by the other undoes the perspective.
+glm::vec2 calculate_texture_coordinates(ScratchModel const& scratch, Triangle const& triangle, glm::vec3 const& lambda) {
+    auto const& texture_coordinates = scratch.texture_coordinates;
+    auto const inv_w = interpolate_barycentrically(scratch.inv_w[triangle[0]], scratch.inv_w[triangle[1]], scratch.inv_w[triangle[2]], lambda);
+
+    return interpolate_barycentrically(
+        texture_coordinates[triangle[0]],
+        texture_coordinates[triangle[1]],
+        texture_coordinates[triangle[2]],
+        lambda
+    ) / inv_w;
+}
+
+// Phong reflection of a single light. Diffuse and specular terms only apply
+// to surfaces facing the light, so that lights never cancel each other out.
+glm::vec3 calculate_illumination(SurfacePoint const& point, Material const& material, Light const& light) {
+    auto const to_light = light.position - point.position;
+    auto const distance = glm::length(to_light);
+    if (distance >= light.radius) {
+        return glm::vec3(0.0f);
+    }
+
+    // Windowed falloff, 1 at the light and reaching 0 with zero slope at the
+    // radius. The ratio is 0 for infinite radii.
+    auto const ratio = distance / light.radius;
+    auto const window = 1.0f - ratio * ratio * ratio * ratio;
+    auto const falloff = window * window;
+
     auto const camera_position = glm::vec3(0.0f, 0.0f, 0.0f);
-    auto const light_position = light.position;
 
-    auto const L = glm::normalize(light_position - position);
-    auto const R = glm::normalize(2 * glm::dot(L, normal) * normal - L);
-    auto const V = glm::normalize(camera_position - position);
+    auto const L = to_light / distance;
+    auto const V = glm::normalize(camera_position - point.position);
+    auto const cos_incidence = glm::dot(L, point.normal);
 
-    auto const ambient_intensity = glm::vec3(0.2f);
-    auto const specular_intensity = glm::vec3(1.0f);
-    auto const diffuse_intensity = glm::vec3(0.8f);
+    auto illumination = material.ambient_reflection() * light.ambient_intensity;
 
-    auto const ambient_illumination = material.ambient_reflection() * ambient_intensity;
-    auto const diffuse_illumination = material.diffuse_reflection() * glm::dot(L, normal) * diffuse_intensity;
-    auto const specular_illumination = material.specular_reflection() *
-        std::pow(std::max(glm::dot(R, V), 0.0f), material.shininess()) * specular_intensity;
-    auto const illumination = ambient_illumination + diffuse_illumination + specular_illumination;
+    if (cos_incidence > 0.0f) {
+        auto const R = glm::normalize(2 * cos_incidence * point.normal - L);
+
+        auto const diffuse_illumination = material.diffuse_reflection() * cos_incidence * light.diffuse_intensity;
+        auto const specular_illumination = material.specular_reflection() *
+            std::pow(std::max(glm::dot(R, V), 0.0f), material.shininess()) * light.specular_intensity;
+
+        illumination += diffuse_illumination + specular_illumination;
+    }
 
-    return illumination;
+    return illumination * falloff;
 }
 
 template <typename T>
@@ -1,12 +1,30 @@
 #pragma once
 
+#include <vcam/core/frame_arena.hh>
 #include <vcam/core/scene.hh>
+#include <vcam/core/thread_pool.hh>
+#include <vcam/core/worker_thread.hh>
+#include <vcam/render/bilinear_upscaler.hh>
+#include <vcam/render/bounding_volume_hierarchy.hh>
+#include <vcam/render/depth_pyramid.hh>
+#include <vcam/render/light_clusters.hh>
 #include <vcam/render/model.hh>
+#include <vcam/render/raster_kernel.hh>
+#include <vcam/render/render_target.hh>
+#include <vcam/render/resolution_controller.hh>
+#include <vcam/render/resolve_kernel.hh>
+#include <vcam/render/texture.hh>
+#include <vcam/render/vertex_kernel.hh>
 
-#include <SDL3/SDL_render.h>
 #include <glm/glm.hpp>
 
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <utility>
 #include <vector>
 
 namespace vcam {
@@ -17,81 +35,628 @@ struct Camera {
     float vfov;
 };
 
+// Point light whose contribution falls off smoothly to nothing at its radius.
+// An infinite radius lights the whole scene at full intensity.
 struct Light {
     glm::vec3 position;
     glm::vec3 ambient_intensity;
     glm::vec3 specular_intensity;
     glm::vec3 diffuse_intensity;
-};
 
-enum ClipPlane {
-    LEFT,
-    RIGHT,
-    BOTTOM,
-    TOP,
-    NEAR,
-    FAR
+    // Zero for free slots, which light nothing.
+    float radius = std::numeric_limits<float>::infinity();
 };
 
+using LightId = std::uint32_t;
+
+// Per-instance copy of a model's geometry as it moves through the pipeline.
+// All of its storage comes from the frame arena.
 struct ScratchModel {
-    Model const& model;
-    std::vector<glm::vec4> vertices;
-    std::vector<std::array<std::size_t, 3>> triangles;
-    std::vector<std::array<glm::vec3, 3>> triangle_normals;
-
-    std::vector<float> depths;
-
-    ScratchModel(Model const& model)
-        : model(model),
-        triangles(model.mesh().triangles()),
-        triangle_normals(model.mesh().triangle_normals()) {
-        vertices.reserve(model.mesh().vertices().size());
-        for (auto const& vertex : model.mesh().vertices()) {
-            vertices.emplace_back(vertex, 1.0f);
+    // The level of detail the instance is drawn with.
+    Mesh const& mesh;
+
+    // The model's material unless the instance overrides it.
+    Material const& material;
+
+    // Screen space vertices (x / w, y / w, z / w, 1 / w), one array per
+    // coordinate. Vertices produced by clipping are appended at the end.
+    std::pmr::vector<float> x;
+    std::pmr::vector<float> y;
+    std::pmr::vector<float> z;
+    std::pmr::vector<float> inv_w;
+
+    // Camera space normals divided by w, so that they interpolate
+    // perspective-correctly. Until transform_attributes runs only the
+    // vertices appended by clipping have one, still in model space.
+    std::pmr::vector<glm::vec3> normals;
+
+    // Texture coordinates divided by w like the normals, empty unless the
+    // material has a texture and the mesh texture coordinates to map it.
+    std::pmr::vector<glm::vec2> texture_coordinates;
+
+    // Triangles which survived clipping.
+    std::pmr::vector<Triangle> triangles;
+    std::pmr::vector<TriangleSetup> triangle_setups;
+
+    // One bit per ClipPlane the vertex lies outside of.
+    std::pmr::vector<std::uint16_t> outcodes;
+
+    ScratchModel(Mesh const& mesh, Material const& material, std::pmr::memory_resource* memory)
+        : mesh(mesh),
+        material(material),
+        x(mesh.vertices().size(), memory),
+        y(mesh.vertices().size(), memory),
+        z(mesh.vertices().size(), memory),
+        inv_w(mesh.vertices().size(), memory),
+        normals(mesh.vertices().size(), memory),
+        texture_coordinates(is_textured(mesh, material) ? mesh.vertices().size() : 0, memory),
+        triangles(memory),
+        triangle_setups(memory),
+        outcodes(mesh.vertices().size(), memory) {
+        triangles.reserve(mesh.triangles().size());
+    }
+
+    glm::vec4 vertex(std::size_t index) const {
+        return { x[index], y[index], z[index], inv_w[index] };
+    }
+
+    // Texture coordinates are dropped if the model is untextured.
+    VertexIndex push_vertex(glm::vec4 const& vertex, glm::vec3 const& normal, glm::vec2 const& vertex_texture_coordinates) {
+        x.push_back(vertex.x);
+        y.push_back(vertex.y);
+        z.push_back(vertex.z);
+        inv_w.push_back(vertex.w);
+        normals.push_back(normal);
+        if (!texture_coordinates.empty()) {
+            texture_coordinates.push_back(vertex_texture_coordinates);
         }
+        return static_cast<VertexIndex>(x.size() - 1);
+    }
+
+    static bool is_textured(Mesh const& mesh, Material const& material) {
+        return material.texture() != nullptr && !mesh.texture_coordinates().empty();
     }
 };
 
+enum class ShadingMode {
+    // Shades every fragment which passes the depth test at the time it's
+    // rasterized, so overlapping geometry gets shaded repeatedly.
+    FORWARD,
+
+    // Rasterizes depth and a visibility record per pixel first, then shades
+    // every visible pixel exactly once.
+    VISIBILITY
+};
+
+// Samples per pixel of the forward shading mode. Coverage and depth are kept
+// per sample, but lighting is evaluated once per pixel for every triangle
+// covering any of its samples, and only the samples it covers get the color.
+// The visibility shading mode always uses a single sample.
+enum class Multisampling {
+    OFF,
+    X4,
+    X8
+};
+
+// Triangle covering a pixel, written by the first phase of the visibility
+// shading mode. The first barycentric coordinate is 1 - beta - gamma.
+struct VisibilityRecord {
+    static constexpr std::uint32_t EMPTY = ~std::uint32_t(0);
+
+    std::uint32_t model;
+    std::uint32_t triangle;
+    float beta;
+    float gamma;
+};
+
+// Linear color of every pixel, one array per channel. Fragments accumulate
+// here unclamped, and the last pass resolves each tile to the target.
+struct ColorBuffer {
+    std::vector<float> red;
+    std::vector<float> green;
+    std::vector<float> blue;
+};
+
+struct FrameStatistics {
+    // Triangles of the levels of detail drawn, before clipping and culling.
+    std::size_t submitted_triangles;
+
+    // Triangles entirely outside the frustum, entirely within the guard
+    // band, and crossing it, which went through the clipper.
+    std::size_t rejected_triangles;
+    std::size_t accepted_triangles;
+    std::size_t clipped_triangles;
+
+    // Triangles facing away from the camera, or degenerate once snapped.
+    std::size_t back_faces;
+
+    // Covered pixels the depth test ran on, and the ones failing it.
+    std::size_t tested_fragments;
+    std::size_t depth_failed_fragments;
+
+    // Fragments which passed the depth test when they were rasterized.
+    std::size_t depth_writes;
+    std::size_t shaded_fragments;
+    std::size_t covered_pixels;
+
+    // Depth writes per covered pixel, which is how many times forward
+    // shading evaluates lighting for each visible pixel on average.
+    double overdraw;
+
+    // Lights reaching the view, and their entries in the cluster lists.
+    std::size_t visible_lights;
+    std::size_t clustered_lights;
+
+    // Instances entirely outside the view frustum.
+    std::size_t frustum_culled_instances;
+
+    // Instances skipped before the vertex stage, and triangles skipped in a
+    // tile before its pixels were walked, by occlusion culling.
+    std::size_t culled_instances;
+    std::size_t culled_triangles;
+
+    // Fraction of the target's resolution the frame was rendered at.
+    double resolution_scale;
+
+    // With multisampling, pixels whose samples didn't all end up with the
+    // same color, and tiles without any such pixel, which resolve straight
+    // from a single color per pixel.
+    std::size_t expanded_pixels;
+    std::size_t compressed_tiles;
+};
+
+// Wall-clock time spent in each stage of the last frame, in milliseconds.
+struct FrameTimings {
+    double begin;
+    double geometry;
+    double clip;
+    double binning;
+    double culling;
+    double raster;
+    double upscale;
+    double present;
+    double total;
+};
+
+using InstanceId = std::uint32_t;
+
+// Null model for free slots.
+struct Instance {
+    Model const* model;
+
+    // Null to use the model's material.
+    Material const* material;
+
+    glm::mat4 model_to_scene_transform;
+};
+
+enum class InstanceChangeType {
+    INSERT,
+    UPDATE,
+    REMOVE
+};
+
+// Edit to the instance hierarchy made since the last frame was submitted.
+// Frames replay these on a hierarchy of their own, so instances can change
+// while a frame is rendered.
+struct InstanceChange {
+    InstanceChangeType type;
+    InstanceId id;
+
+    // Scene space bounds, unused by removals.
+    BoundingBox bounds;
+};
+
+// Everything a frame is rendered from, copied out of the scene when the
+// frame is submitted and left untouched until it's finished.
+struct FrameSnapshot {
+    Camera camera;
+    ShadingMode shading_mode;
+    Multisampling multisampling;
+    TextureFiltering texture_filtering;
+    bool occlusion_culling;
+    float level_of_detail_threshold;
+    ResolveSettings resolve_settings;
+    float resolution_scale;
+
+    std::vector<Instance> instances;
+    std::vector<InstanceChange> instance_changes;
+    std::vector<Light> lights;
+};
+
+struct TriangleReference {
+    std::size_t model;
+    std::size_t triangle;
+};
+
+struct Tile {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+};
+
+// Colors of the samples of a tile's pixels. Pixels whose samples all share
+// one color keep it in the color buffer only, and a bit of expanded_rows
+// marks each pixel whose samples differ, which keeps its colors here
+// instead. Tiles without such pixels never touch their colors, which are
+// only allocated once a tile first needs them.
+struct TileSamples {
+    std::array<std::uint64_t, MAX_ROW_PIXELS> expanded_rows;
+
+    // sample_count colors per pixel, pixels in rows of TILE_SIZE.
+    std::vector<glm::vec3> colors;
+};
+
+// Per-frame state shared by all raster workers.
+struct RasterContext {
+    glm::mat4 projection_to_camera_transform;
+    glm::mat4 viewport_to_projection_transform;
+    int width;
+    int height;
+
+    // One unless the frame is multisampled.
+    int sample_count;
+
+    // With occlusion culling frames are rasterized in two passes. The first
+    // one clears the tiles, the last one resolves them.
+    bool first_pass;
+    bool last_pass;
+};
+
 class RenderSystem {
 public:
-    explicit RenderSystem(SDL_Renderer* renderer)
-        : m_renderer(renderer) { }
+    static constexpr int TILE_SIZE = 64;
 
+    // A thread count of zero uses every hardware thread.
+    explicit RenderSystem(std::unique_ptr<IRenderTarget> target, std::size_t thread_count = 0)
+        : m_target(std::move(target)), m_thread_pool(std::make_unique<ThreadPool>(thread_count)) { }
+
+    ~RenderSystem() {
+        finish_frame();
+    }
+
+    // Renders the scene as it is now and presents it before returning.
     void render();
 
+    // Presents the frame in flight, if any, then starts rendering the scene
+    // as it is now on the render thread and returns. Changes made to the
+    // scene meanwhile only show up in the next frame, so there's never more
+    // than one frame in flight. Models and materials of removed instances
+    // have to outlive the frame in flight, see release_after_frame.
+    void submit_frame();
+
+    // Waits for the frame in flight, if any, and presents it.
+    void finish_frame();
+
+    // Keeps the resource alive until the frame in flight, if any, is
+    // finished, so the last owner of a removed instance's model or material
+    // can let go of it right away. Without a frame in flight it's released
+    // at once.
+    void release_after_frame(std::shared_ptr<void const> resource);
+
     void camera(Camera camera) {
         m_camera = camera;
     }
 
-    void light(Light light) {
-        m_light = light;
+    void shading_mode(ShadingMode mode) {
+        m_shading_mode = mode;
     }
 
-    void add_instance(Model const& model, glm::mat4 model_to_scene_transform);
+    ShadingMode shading_mode() const {
+        return m_shading_mode;
+    }
+
+    // Skips instances and triangles hidden behind what's already drawn.
+    void occlusion_culling(bool enabled) {
+        m_occlusion_culling = enabled;
+    }
+
+    bool occlusion_culling() const {
+        return m_occlusion_culling;
+    }
+
+    void multisampling(Multisampling multisampling) {
+        m_multisampling = multisampling;
+    }
+
+    Multisampling multisampling() const {
+        return m_multisampling;
+    }
+
+    void texture_filtering(TextureFiltering filtering) {
+        m_texture_filtering = filtering;
+    }
+
+    TextureFiltering texture_filtering() const {
+        return m_texture_filtering;
+    }
+
+    // Instances are drawn with the coarsest level of detail whose error
+    // projects to at most this many pixels.
+    void level_of_detail_threshold(float pixels) {
+        m_level_of_detail_threshold = pixels;
+    }
+
+    float level_of_detail_threshold() const {
+        return m_level_of_detail_threshold;
+    }
+
+    // Scales linear color before tone mapping, so values above 1 can be
+    // brought back into range rather than clipped.
+    void exposure(float exposure) {
+        m_resolve_settings.exposure = exposure;
+    }
+
+    float exposure() const {
+        return m_resolve_settings.exposure;
+    }
+
+    void tone_mapping(ToneMapping tone_mapping) {
+        m_resolve_settings.tone_mapping = tone_mapping;
+    }
+
+    ToneMapping tone_mapping() const {
+        return m_resolve_settings.tone_mapping;
+    }
+
+    // Renders at a fraction of the target's resolution, picked after every
+    // frame so that rasterizing and upscaling take about this many
+    // milliseconds, and upscales the result to the target. Zero always
+    // renders at the target's resolution.
+    void raster_budget(double milliseconds) {
+        m_resolution_controller.budget(milliseconds);
+    }
+
+    double raster_budget() const {
+        return m_resolution_controller.budget();
+    }
+
+    // Fraction of the target's resolution the next frame is rendered at.
+    float resolution_scale() const {
+        return m_resolution_controller.scale();
+    }
+
+    // Instances stay in the scene until they're removed. The model has to
+    // outlive its instances.
+    InstanceId add_instance(Model const& model, glm::mat4 model_to_scene_transform);
+    void update_instance(InstanceId id, glm::mat4 model_to_scene_transform);
+    void remove_instance(InstanceId id);
+
+    // Adds an instance of the model per transform, with consecutive ids
+    // starting at the returned one. Materials are either empty or one per
+    // transform, overriding the model's material per instance, and have to
+    // outlive the instances too.
+    InstanceId add_instances(
+        Model const& model,
+        std::span<glm::mat4 const> model_to_scene_transforms,
+        std::span<Material const> materials = {}
+    );
+    void update_instances(InstanceId first, std::span<glm::mat4 const> model_to_scene_transforms);
+    void remove_instances(InstanceId first, std::size_t count);
+
+    // Lights stay in the scene until they're removed, like instances.
+    LightId add_light(Light const& light);
+    void update_light(LightId id, Light const& light);
+    void remove_light(LightId id);
+
+    IRenderTarget& target() {
+        return *m_target;
+    }
+
+    // Reverse depth of the last rendered frame, one value per pixel at the
+    // resolution it was rendered at, the farthest of its samples if it was
+    // multisampled. Like the color buffer and the frame arena, it's only
+    // stable while no frame is in flight.
+    std::vector<float> const& depth_buffer() const {
+        return m_depth_buffer;
+    }
+
+    // Linear color of the last rendered frame, before exposure and tone
+    // mapping, with the samples of every pixel averaged.
+    ColorBuffer const& color_buffer() const {
+        return m_color_buffer;
+    }
+
+    // Timings and statistics of the last presented frame.
+    FrameTimings const& last_frame_timings() const {
+        return m_last_frame_timings;
+    }
+
+    FrameStatistics const& last_frame_statistics() const {
+        return m_last_frame_statistics;
+    }
+
+    FrameArena const& frame_arena() const {
+        return m_frame_arena;
+    }
 
 private:
-    SDL_Renderer* m_renderer;
+    std::unique_ptr<IRenderTarget> m_target;
+
+    // The scene, which only the submitting thread touches. Frames are
+    // rendered from a snapshot of it.
     Camera m_camera;
-    Light m_light;
+    ShadingMode m_shading_mode = ShadingMode::FORWARD;
+    Multisampling m_multisampling = Multisampling::OFF;
+    TextureFiltering m_texture_filtering = TextureFiltering::TRILINEAR;
+    bool m_occlusion_culling = true;
+    float m_level_of_detail_threshold = 1.0f;
+    ResolveSettings m_resolve_settings;
+    ResolutionController m_resolution_controller;
+
+    // Indexed by InstanceId, removed instances leave their slot free for
+    // the next one added.
+    std::vector<Instance> m_instances;
+    std::vector<InstanceId> m_free_instances;
+    std::vector<InstanceChange> m_instance_changes;
+
+    // Indexed by LightId, free slots are reused like instance slots.
+    std::vector<Light> m_lights;
+    std::vector<LightId> m_free_lights;
+
+    // Everything below belongs to the frame being rendered, and is only
+    // touched by the thread rendering it.
+    FrameSnapshot m_frame;
+
+    // Runs submitted frames, started by the first one.
+    std::unique_ptr<WorkerThread> m_render_thread;
+    bool m_frame_in_flight = false;
+
+    // Resources released while a frame was in flight, freed once it's done.
+    std::vector<std::shared_ptr<void const>> m_released_resources;
+
+    // Scene space bounds of every instance.
+    BoundingVolumeHierarchy m_instance_hierarchy;
+
+    // Whether each instance passed the occlusion test at the end of the
+    // last frame it was inside the frustum in.
+    std::vector<bool> m_visible_instances;
+
+    // Index into the model's levels of detail each instance was last drawn
+    // with, kept between frames so that switching levels can lag behind.
+    std::vector<std::size_t> m_instance_levels_of_detail;
+
+    // Cleared rather than freed after every frame, like the containers
+    // below, so they stop allocating once they've grown to fit a frame.
+    // Sorted by model, so instances sharing one are processed together.
+    std::vector<InstanceId> m_frustum_instances;
+
+    // Lights reaching the view this frame, in camera space, and the ones
+    // reaching each cluster as indices into them. Clusters span a quarter of
+    // a tile, since tiles are too coarse to separate hundreds of lights.
+    std::vector<Light> m_frame_lights;
+    LightClusters m_light_clusters{ TILE_SIZE / 2 };
+
+    std::unique_ptr<ThreadPool> m_thread_pool;
+    VertexKernel m_vertex_kernel = select_vertex_kernel();
+    RowKernel m_row_kernel = select_row_kernel();
+    ResolveKernel m_resolve_kernel = select_resolve_kernel();
+
+    // Backs every ScratchModel and is reset at the end of each frame.
+    FrameArena m_frame_arena;
+    std::vector<ScratchModel> m_scratch_models;
+    std::vector<std::vector<TriangleReference>> m_tile_bins;
+    int m_tile_columns = 0;
+    int m_tile_rows = 0;
+
+    Framebuffer m_framebuffer{};
+
+    // Where tiles are resolved to, the framebuffer itself unless the frame
+    // is rendered at a lower resolution and upscaled from m_scaled_pixels.
+    Framebuffer m_resolve_target{};
+    std::vector<std::uint32_t> m_scaled_pixels;
+    BilinearUpscaler m_upscaler;
+
+    ColorBuffer m_color_buffer;
+    std::vector<float> m_depth_buffer;
+    std::vector<VisibilityRecord> m_visibility_buffer;
+
+    // Multisampled frames only. Depths are kept as one plane per sample,
+    // each laid out like the depth buffer, so the row kernels can scan a
+    // sample of every pixel at a time. Tiles keep their sample colors
+    // between frames, so they stop allocating once they've expanded.
+    std::vector<float> m_sample_depths;
+    std::vector<TileSamples> m_tile_samples;
+    DepthPyramid m_depth_pyramid{ TILE_SIZE };
+
+    // Counted per tile so workers never share a counter.
+    std::vector<FrameStatistics> m_tile_statistics;
 
-    std::unordered_multimap<Model const*, glm::mat4> m_models;
+    // Published as the last frame's once the frame is presented.
+    FrameTimings m_frame_timings{};
+    FrameStatistics m_frame_statistics{};
 
-    void transform_model(ScratchModel& scratch, glm::mat4 const& model_to_camera_transform);
-    void project_model(ScratchModel& scratch, glm::mat4 const& camera_to_projection_transform);
-    void clip_model(ScratchModel& scratch);
-    void normalize_model(ScratchModel& scratch);
-    void viewport_model(ScratchModel& scratch, glm::mat4 const& projection_to_viewport_transform);
+    FrameTimings m_last_frame_timings{};
+    FrameStatistics m_last_frame_statistics{};
 
-    void rasterize_model(
+    void begin_frame();
+    void render_frame();
+    void present_frame();
+
+    void apply_instance_changes();
+
+    void transform_model(ScratchModel& scratch, glm::mat4 const& model_to_viewport_transform, glm::vec2 const& viewport_size);
+    void clip_model(
+        ScratchModel& scratch,
+        glm::mat4 const& model_to_viewport_transform,
+        glm::vec2 const& viewport_size,
+        FrameStatistics& statistics
+    );
+
+    void transform_attributes(ScratchModel& scratch, glm::mat3 const& normal_transform);
+
+    void bin_model(
         ScratchModel& scratch,
-        glm::mat4 const& projection_to_camera_transform,
-        glm::mat4 const& viewport_to_projection_transform,
-        std::vector<float>& z_buffer,
+        std::size_t model_index,
+        int width,
+        int height,
+        int sample_count,
+        FrameStatistics& statistics
+    );
+
+    Tile calculate_tile(std::size_t tile_index, int width, int height) const;
+    void clear_tile(std::size_t tile_index, Tile const& tile, RasterContext const& context);
+    void rasterize_tile(std::size_t tile_index, RasterContext const& context);
+
+    void rasterize_triangle(
+        ScratchModel const& scratch,
+        std::size_t triangle_index,
+        Tile const& tile,
+        RasterContext const& context,
+        FrameStatistics& statistics
+    );
+
+    void rasterize_triangle_visibility(
+        std::size_t model_index,
+        std::size_t triangle_index,
+        Tile const& tile,
+        RasterContext const& context,
+        FrameStatistics& statistics
+    );
+
+    bool is_triangle_occluded(
+        TriangleSetup const& setup,
+        Tile const& bounds,
+        RasterContext const& context,
+        FrameStatistics& statistics
+    ) const;
+
+    void rasterize_triangle_multisampled(
+        ScratchModel const& scratch,
+        std::size_t triangle_index,
+        Tile const& tile,
+        TileSamples& samples,
+        RasterContext const& context,
+        FrameStatistics& statistics
+    );
+
+    void resolve_sample_depths(Tile const& tile, RasterContext const& context, FrameStatistics& statistics);
+    void resolve_samples(Tile const& tile, TileSamples const& samples, RasterContext const& context, FrameStatistics& statistics);
+
+    void resolve_visibility_tile(Tile const& tile, RasterContext const& context, FrameStatistics& statistics);
+    void resolve_tile(Tile const& tile, int width);
+    void upscale_frame();
+
+    void cluster_lights(
+        glm::mat4 const& scene_to_camera_transform,
+        glm::mat4 const& camera_to_projection_transform,
+        glm::mat4 const& projection_to_viewport_transform,
         int width,
         int height
     );
 
-    SDL_Surface* m_surface = nullptr;
+    // Lights the fragment at pixel (x, y) with the lights of its cluster.
+    // Textures are sampled with the derivatives across the 2 x 2 quad of
+    // pixels the fragment lies in.
+    glm::vec3 shade_fragment(
+        ScratchModel const& scratch,
+        std::size_t triangle_index,
+        glm::vec3 const& lambda,
+        int x,
+        int y,
+        RasterContext const& context
+    ) const;
 };
 
 }
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vcam {
+
+// Packed RGBA8888 pixels, red in the most significant byte. Stride is the
+// distance between the starts of consecutive rows, in pixels.
+struct Framebuffer {
+    std::uint32_t* pixels;
+    int stride;
+    int width;
+    int height;
+};
+
+// Destination of the frames produced by RenderSystem. begin_frame hands out
+// pixel memory to rasterize into, valid until end_frame publishes it.
+class IRenderTarget {
+public:
+    virtual ~IRenderTarget() = default;
+    virtual Framebuffer begin_frame() = 0;
+    virtual void end_frame() = 0;
+};
+
+}
@@ -0,0 +1,46 @@
+#include <vcam/render/resolution_controller.hh>
+
+#include <algorithm>
+#include <cmath>
+
+namespace vcam {
+
+// Weight of the latest frame in the estimate, which smooths out single
+// frames without lagging far behind changes in the scene.
+static constexpr double SMOOTHING = 0.25;
+
+// Fraction of the budget aimed for, leaving room for frames costing more
+// than the estimate.
+static constexpr double HEADROOM = 0.9;
+
+void ResolutionController::budget(double milliseconds) {
+    m_budget = std::max(milliseconds, 0.0);
+    m_scale = 1.0f;
+    m_full_resolution_time = 0.0;
+}
+
+void ResolutionController::update(double milliseconds) {
+    if (m_budget <= 0.0 || milliseconds <= 0.0) {
+        return;
+    }
+
+    auto const full_resolution_time = milliseconds / (static_cast<double>(m_scale) * m_scale);
+    m_full_resolution_time = m_full_resolution_time > 0.0
+        ? m_full_resolution_time + (full_resolution_time - m_full_resolution_time) * SMOOTHING
+        : full_resolution_time;
+
+    auto const ideal_scale = static_cast<float>(std::sqrt(m_budget * HEADROOM / m_full_resolution_time));
+
+    // Frames over budget drop straight to a scale which fits, but recover
+    // only a step at a time, and only once a whole step fits, so the scale
+    // settles instead of oscillating around the ideal one.
+    if (ideal_scale < m_scale) {
+        m_scale = std::floor(ideal_scale / SCALE_STEP) * SCALE_STEP;
+    } else if (ideal_scale >= m_scale + SCALE_STEP) {
+        m_scale += SCALE_STEP;
+    }
+
+    m_scale = std::clamp(m_scale, MIN_SCALE, 1.0f);
+}
+
+}
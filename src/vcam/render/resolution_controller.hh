@@ -0,0 +1,42 @@
+#pragma once
+
+namespace vcam {
+
+// Picks the fraction of the output resolution to render at, so that the
+// time spent on pixels stays within a budget. That time is assumed to grow
+// with the pixel count, i.e. with the square of the scale, which turns each
+// measurement into an estimate of the cost at full resolution.
+class ResolutionController {
+public:
+    static constexpr float MIN_SCALE = 0.25f;
+
+    // Scales change in steps of this, so buffers are only resized once in a
+    // while rather than every frame.
+    static constexpr float SCALE_STEP = 1.0f / 16.0f;
+
+    // Zero turns scaling off, rendering at full resolution.
+    void budget(double milliseconds);
+
+    double budget() const {
+        return m_budget;
+    }
+
+    // Takes the pixel time of a frame rendered at the current scale and
+    // picks the scale of the next one. Frames with no pixel time at all,
+    // which had nothing to draw into, are ignored.
+    void update(double milliseconds);
+
+    float scale() const {
+        return m_scale;
+    }
+
+private:
+    double m_budget = 0.0;
+    float m_scale = 1.0f;
+
+    // Smoothed estimate of the pixel time at full resolution, or zero
+    // before the first measurement.
+    double m_full_resolution_time = 0.0;
+};
+
+}
@@ -0,0 +1,169 @@
+#include <vcam/core/simd.hh>
+#include <vcam/render/resolve_kernel.hh>
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+namespace vcam {
+
+// Encoded values are looked up rather than computed, since the transfer
+// function needs a pow per channel. Entries are 32 bits wide so that AVX2
+// can gather them directly. Between neighboring entries the encoding changes
+// by less than one 8-bit step, so lookups are off by at most one.
+constexpr std::size_t SRGB_TABLE_SIZE = 4096;
+
+static std::array<std::uint32_t, SRGB_TABLE_SIZE> calculate_srgb_table() {
+    std::array<std::uint32_t, SRGB_TABLE_SIZE> table;
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        auto const linear = static_cast<float>(i) / (SRGB_TABLE_SIZE - 1);
+        auto const encoded = linear <= 0.0031308f
+            ? linear * 12.92f
+            : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        table[i] = static_cast<std::uint32_t>(std::clamp(encoded, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    return table;
+}
+
+static std::array<std::uint32_t, SRGB_TABLE_SIZE> const SRGB_TABLE = calculate_srgb_table();
+
+static std::uint32_t pack_pixel(std::uint32_t red, std::uint32_t green, std::uint32_t blue) {
+    return (red << 24) | (green << 16) | (blue << 8) | 0xFF;
+}
+
+static std::uint32_t encode_channel(float value, ResolveSettings const& settings) {
+    value *= settings.exposure;
+    if (settings.tone_mapping == ToneMapping::REINHARD) {
+        value /= 1.0f + value;
+    }
+
+    auto const clamped = value > 0.0f ? std::min(value, 1.0f) : 0.0f;
+    return SRGB_TABLE[static_cast<std::size_t>(clamped * (SRGB_TABLE_SIZE - 1) + 0.5f)];
+}
+
+static void resolve_row_scalar(
+    float const* red,
+    float const* green,
+    float const* blue,
+    int count,
+    ResolveSettings const& settings,
+    std::uint32_t* pixels
+) {
+    for (int i = 0; i < count; ++i) {
+        pixels[i] = pack_pixel(
+            encode_channel(red[i], settings),
+            encode_channel(green[i], settings),
+            encode_channel(blue[i], settings)
+        );
+    }
+}
+
+#ifdef VCAM_X86
+
+// Returns table indices. max_ps returns its second operand if either is
+// NaN, which maps NaN to 0 like the scalar kernel.
+static __m128i calculate_table_indices_sse(__m128 value, ResolveSettings const& settings) {
+    auto const one = _mm_set1_ps(1.0f);
+
+    value = _mm_mul_ps(value, _mm_set1_ps(settings.exposure));
+    if (settings.tone_mapping == ToneMapping::REINHARD) {
+        value = _mm_div_ps(value, _mm_add_ps(one, value));
+    }
+
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), one);
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(SRGB_TABLE_SIZE - 1)), _mm_set1_ps(0.5f)));
+}
+
+static void resolve_row_sse(
+    float const* red,
+    float const* green,
+    float const* blue,
+    int count,
+    ResolveSettings const& settings,
+    std::uint32_t* pixels
+) {
+    // SSE2 has no gathers, so only the arithmetic is vectorized.
+    alignas(16) std::array<std::int32_t, 4> r;
+    alignas(16) std::array<std::int32_t, 4> g;
+    alignas(16) std::array<std::int32_t, 4> b;
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_store_si128(reinterpret_cast<__m128i*>(r.data()), calculate_table_indices_sse(_mm_loadu_ps(red + i), settings));
+        _mm_store_si128(reinterpret_cast<__m128i*>(g.data()), calculate_table_indices_sse(_mm_loadu_ps(green + i), settings));
+        _mm_store_si128(reinterpret_cast<__m128i*>(b.data()), calculate_table_indices_sse(_mm_loadu_ps(blue + i), settings));
+
+        for (int lane = 0; lane < 4; ++lane) {
+            pixels[i + lane] = pack_pixel(SRGB_TABLE[r[lane]], SRGB_TABLE[g[lane]], SRGB_TABLE[b[lane]]);
+        }
+    }
+
+    resolve_row_scalar(red + i, green + i, blue + i, count - i, settings, pixels + i);
+}
+
+VCAM_TARGET_AVX2
+static __m256i encode_channel_avx2(__m256 value, ResolveSettings const& settings) {
+    auto const one = _mm256_set1_ps(1.0f);
+
+    value = _mm256_mul_ps(value, _mm256_set1_ps(settings.exposure));
+    if (settings.tone_mapping == ToneMapping::REINHARD) {
+        value = _mm256_div_ps(value, _mm256_add_ps(one, value));
+    }
+
+    value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), one);
+    auto const indices = _mm256_cvttps_epi32(
+        _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(SRGB_TABLE_SIZE - 1)), _mm256_set1_ps(0.5f))
+    );
+
+    return _mm256_i32gather_epi32(reinterpret_cast<int const*>(SRGB_TABLE.data()), indices, 4);
+}
+
+VCAM_TARGET_AVX2
+static void resolve_row_avx2(
+    float const* red,
+    float const* green,
+    float const* blue,
+    int count,
+    ResolveSettings const& settings,
+    std::uint32_t* pixels
+) {
+    auto const alpha = _mm256_set1_epi32(0xFF);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto const r = encode_channel_avx2(_mm256_loadu_ps(red + i), settings);
+        auto const g = encode_channel_avx2(_mm256_loadu_ps(green + i), settings);
+        auto const b = encode_channel_avx2(_mm256_loadu_ps(blue + i), settings);
+
+        auto const packed = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi32(r, 24), _mm256_slli_epi32(g, 16)),
+            _mm256_or_si256(_mm256_slli_epi32(b, 8), alpha)
+        );
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i), packed);
+    }
+
+    resolve_row_scalar(red + i, green + i, blue + i, count - i, settings, pixels + i);
+}
+
+#endif
+
+ResolveKernel select_resolve_kernel() {
+#ifdef VCAM_X86
+    if (SDL_HasAVX2()) {
+        return resolve_row_avx2;
+    }
+
+    if (SDL_HasSSE2()) {
+        return resolve_row_sse;
+    }
+#endif
+
+    return resolve_row_scalar;
+}
+
+}
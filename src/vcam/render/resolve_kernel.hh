@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+namespace vcam {
+
+enum class ToneMapping {
+    // Clips every channel to [0, 1].
+    CLAMP,
+
+    // Maps [0, inf) onto [0, 1) with c / (1 + c), so highlights are
+    // compressed instead of clipped.
+    REINHARD
+};
+
+struct ResolveSettings {
+    // Linear color is scaled by this before tone mapping.
+    float exposure = 1.0f;
+    ToneMapping tone_mapping = ToneMapping::CLAMP;
+};
+
+// Exposes and tone maps count linear colors, given as one array per channel,
+// encodes them with the sRGB transfer function and packs them into pixels as
+// opaque RGBA8888. NaN channels resolve to 0.
+using ResolveKernel = void (*)(
+    float const* red,
+    float const* green,
+    float const* blue,
+    int count,
+    ResolveSettings const& settings,
+    std::uint32_t* pixels
+);
+
+// Picks the widest kernel the running CPU supports.
+ResolveKernel select_resolve_kernel();
+
+}
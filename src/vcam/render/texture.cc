@@ -0,0 +1,200 @@
+#include <vcam/render/texture.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace vcam {
+
+static constexpr int TILE_TEXELS = Texture::TILE_SIZE * Texture::TILE_SIZE;
+
+// Decoding every channel of every texel read would take a pow each, so the
+// 256 possible values are decoded once.
+static std::array<float, 256> calculate_srgb_decode_table() {
+    std::array<float, 256> table;
+
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        auto const encoded = static_cast<float>(i) / 255.0f;
+        table[i] = encoded <= 0.04045f
+            ? encoded / 12.92f
+            : std::pow((encoded + 0.055f) / 1.055f, 2.4f);
+    }
+
+    return table;
+}
+
+static std::array<float, 256> const SRGB_DECODE_TABLE = calculate_srgb_decode_table();
+
+static glm::vec3 decode_texel(std::uint32_t texel);
+static std::uint32_t encode_texel(glm::vec3 const& color);
+static std::uint32_t calculate_morton_index(int x, int y);
+
+Texture::Texture(int width, int height, std::span<std::uint32_t const> pixels) {
+    // Levels are averaged from the linear color of the level before, not
+    // from its rounded texels, so rounding errors don't add up.
+    std::vector<glm::vec3> colors(pixels.size());
+    std::transform(pixels.begin(), pixels.end(), colors.begin(), decode_texel);
+
+    auto const add_level = [&](int level_width, int level_height) -> Level& {
+        auto& level = m_levels.emplace_back();
+        level.width = level_width;
+        level.height = level_height;
+        level.tile_columns = (level_width + TILE_SIZE - 1) / TILE_SIZE;
+
+        auto const tile_rows = (level_height + TILE_SIZE - 1) / TILE_SIZE;
+        level.texels.resize(static_cast<std::size_t>(level.tile_columns) * tile_rows * TILE_TEXELS);
+        return level;
+        };
+
+    auto& first_level = add_level(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            auto const tile = static_cast<std::size_t>(y / TILE_SIZE) * first_level.tile_columns + x / TILE_SIZE;
+            first_level.texels[tile * TILE_TEXELS + calculate_morton_index(x, y)] = pixels[static_cast<std::size_t>(y) * width + x];
+        }
+    }
+
+    // Odd sizes round down, so the last row or column of such a level only
+    // reaches the next one through its neighbor's box.
+    while (width > 1 || height > 1) {
+        auto const next_width = std::max(width / 2, 1);
+        auto const next_height = std::max(height / 2, 1);
+
+        std::vector<glm::vec3> next_colors(static_cast<std::size_t>(next_width) * next_height);
+        auto& level = add_level(next_width, next_height);
+
+        for (int y = 0; y < next_height; ++y) {
+            auto const y0 = static_cast<std::size_t>(y * 2);
+            auto const y1 = static_cast<std::size_t>(std::min(y * 2 + 1, height - 1));
+
+            for (int x = 0; x < next_width; ++x) {
+                auto const x0 = static_cast<std::size_t>(x * 2);
+                auto const x1 = static_cast<std::size_t>(std::min(x * 2 + 1, width - 1));
+
+                auto const color = (colors[y0 * width + x0] + colors[y0 * width + x1] +
+                    colors[y1 * width + x0] + colors[y1 * width + x1]) * 0.25f;
+                next_colors[static_cast<std::size_t>(y) * next_width + x] = color;
+
+                auto const tile = static_cast<std::size_t>(y / TILE_SIZE) * level.tile_columns + x / TILE_SIZE;
+                level.texels[tile * TILE_TEXELS + calculate_morton_index(x, y)] = encode_texel(color);
+            }
+        }
+
+        colors = std::move(next_colors);
+        width = next_width;
+        height = next_height;
+    }
+}
+
+// The footprint of a pixel spans the larger of its derivatives, scaled to
+// texels. Each level doubles the texel spacing, so the level matching the
+// footprint is its log2, which is half the log2 of its squared length.
+glm::vec3 Texture::sample(glm::vec2 uv, glm::vec2 uv_dx, glm::vec2 uv_dy, TextureFiltering filtering) const {
+    if (!std::isfinite(uv.x + uv.y)) {
+        return glm::vec3(0.0f);
+    }
+
+    auto const size = glm::vec2(static_cast<float>(width()), static_cast<float>(height()));
+    auto const texel_dx = uv_dx * size;
+    auto const texel_dy = uv_dy * size;
+    auto const footprint = std::max(glm::dot(texel_dx, texel_dx), glm::dot(texel_dy, texel_dy));
+
+    // Magnified texels all come from the first level. This also catches
+    // footprints which aren't finite.
+    auto const max_level = static_cast<float>(m_levels.size() - 1);
+    auto const level_of_detail = footprint > 1.0f ? std::min(0.5f * std::log2(footprint), max_level) : 0.0f;
+
+    if (filtering == TextureFiltering::BILINEAR) {
+        return sample_level(m_levels[static_cast<std::size_t>(level_of_detail + 0.5f)], uv);
+    }
+
+    auto const level = static_cast<std::size_t>(level_of_detail);
+    auto const blend = level_of_detail - static_cast<float>(level);
+
+    auto const color = sample_level(m_levels[level], uv);
+    if (blend == 0.0f) {
+        return color;
+    }
+
+    return glm::mix(color, sample_level(m_levels[level + 1], uv), blend);
+}
+
+// Texel centers lie at half a texel, and the texels past the last column or
+// row are those of the first, as the texture repeats.
+glm::vec3 Texture::sample_level(Level const& level, glm::vec2 uv) const {
+    auto const x = (uv.x - std::floor(uv.x)) * static_cast<float>(level.width) - 0.5f;
+    auto const y = (uv.y - std::floor(uv.y)) * static_cast<float>(level.height) - 0.5f;
+
+    auto const x_floor = std::floor(x);
+    auto const y_floor = std::floor(y);
+    auto const x_weight = x - x_floor;
+    auto const y_weight = y - y_floor;
+
+    auto x0 = static_cast<int>(x_floor);
+    auto y0 = static_cast<int>(y_floor);
+    auto x1 = x0 + 1;
+    auto y1 = y0 + 1;
+
+    x0 = x0 < 0 ? x0 + level.width : x0;
+    y0 = y0 < 0 ? y0 + level.height : y0;
+    x1 = x1 >= level.width ? x1 - level.width : x1;
+    y1 = y1 >= level.height ? y1 - level.height : y1;
+
+    auto const top = glm::mix(decode_texel(level.texel(x0, y0)), decode_texel(level.texel(x1, y0)), x_weight);
+    auto const bottom = glm::mix(decode_texel(level.texel(x0, y1)), decode_texel(level.texel(x1, y1)), x_weight);
+
+    return glm::mix(top, bottom, y_weight);
+}
+
+std::uint32_t Texture::Level::texel(int x, int y) const {
+    auto const tile = static_cast<std::size_t>(y / TILE_SIZE) * tile_columns + x / TILE_SIZE;
+    return texels[tile * TILE_TEXELS + calculate_morton_index(x, y)];
+}
+
+Texture generate_checkerboard_texture(int size, int squares, glm::vec3 color, glm::vec3 other_color) {
+    auto const texel = encode_texel(color);
+    auto const other_texel = encode_texel(other_color);
+
+    std::vector<std::uint32_t> pixels(static_cast<std::size_t>(size) * size);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            auto const is_other = (x * squares / size + y * squares / size) % 2 != 0;
+            pixels[static_cast<std::size_t>(y) * size + x] = is_other ? other_texel : texel;
+        }
+    }
+
+    return Texture(size, size, pixels);
+}
+
+glm::vec3 decode_texel(std::uint32_t texel) {
+    return {
+        SRGB_DECODE_TABLE[texel >> 24],
+        SRGB_DECODE_TABLE[(texel >> 16) & 0xFF],
+        SRGB_DECODE_TABLE[(texel >> 8) & 0xFF]
+    };
+}
+
+std::uint32_t encode_texel(glm::vec3 const& color) {
+    auto const encode_channel = [](float linear) {
+        auto const clamped = std::clamp(linear, 0.0f, 1.0f);
+        auto const encoded = clamped <= 0.0031308f
+            ? clamped * 12.92f
+            : 1.055f * std::pow(clamped, 1.0f / 2.4f) - 0.055f;
+        return static_cast<std::uint32_t>(encoded * 255.0f + 0.5f);
+        };
+
+    return (encode_channel(color.r) << 24) | (encode_channel(color.g) << 16) | (encode_channel(color.b) << 8) | 0xFF;
+}
+
+// Interleaves the bits of the position within a tile, x in the even bits
+// and y in the odd ones.
+std::uint32_t calculate_morton_index(int x, int y) {
+    auto const tile_x = static_cast<std::uint32_t>(x % Texture::TILE_SIZE);
+    auto const tile_y = static_cast<std::uint32_t>(y % Texture::TILE_SIZE);
+
+    return (tile_x & 1) | ((tile_y & 1) << 1) |
+        ((tile_x & 2) << 1) | ((tile_y & 2) << 2) |
+        ((tile_x & 4) << 2) | ((tile_y & 4) << 3);
+}
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace vcam {
+
+enum class TextureFiltering {
+    // Blends the four texels around the sample in the mip level nearest to
+    // the footprint, which steps visibly where the level changes.
+    BILINEAR,
+
+    // Blends bilinear samples of the two mip levels around the footprint.
+    TRILINEAR
+};
+
+// Mip chain of an sRGB color image, sampled with texture coordinates that
+// run from (0, 0) at the top-left corner of the image to (1, 1) at its
+// bottom-right corner and repeat beyond.
+//
+// Texels are stored in tiles of 8 x 8, with the texels of a tile in Morton
+// order, so that every 4 x 4 block fills one cache line and the texels a
+// sample reads lie close together whichever way the surface is oriented on
+// screen. Tiles are stored row by row.
+class Texture {
+public:
+    static constexpr int TILE_SIZE = 8;
+
+    // Pixels are packed RGBA8888 like the render target's, sRGB encoded, in
+    // rows from the top, and there have to be width x height of them, with
+    // both sizes positive. Alpha is ignored. Every further level halves the
+    // previous one's size, averaging it in linear color, down to 1 x 1.
+    explicit Texture(int width, int height, std::span<std::uint32_t const> pixels);
+
+    int width() const {
+        return m_levels.front().width;
+    }
+
+    int height() const {
+        return m_levels.front().height;
+    }
+
+    std::size_t level_count() const {
+        return m_levels.size();
+    }
+
+    // Linear color at the texture coordinates. The derivatives are how much
+    // the coordinates change from one pixel to the next along x and y, which
+    // picks the mip level whose texels are about a pixel apart.
+    glm::vec3 sample(glm::vec2 uv, glm::vec2 uv_dx, glm::vec2 uv_dy, TextureFiltering filtering) const;
+
+private:
+    struct Level {
+        int width;
+        int height;
+        int tile_columns;
+        std::vector<std::uint32_t> texels;
+
+        std::uint32_t texel(int x, int y) const;
+    };
+
+    std::vector<Level> m_levels;
+
+    glm::vec3 sample_level(Level const& level, glm::vec2 uv) const;
+};
+
+// Square texture of size x size texels, checkered with squares x squares
+// squares of the two colors, given in linear color.
+Texture generate_checkerboard_texture(int size, int squares, glm::vec3 color, glm::vec3 other_color);
+
+}
@@ -0,0 +1,44 @@
+#include <vcam/render/texture_import.hh>
+
+#include <SDL3/SDL.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace vcam {
+
+// Rows are copied out of the converted surface, as its pitch may pad them.
+std::optional<Texture> import_bmp(std::filesystem::path const& path) {
+    auto* const surface = SDL_LoadBMP(path.string().c_str());
+    if (surface == nullptr) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to import %s: %s", path.string().c_str(), SDL_GetError());
+        return std::nullopt;
+    }
+
+    auto* const converted = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA8888);
+    SDL_DestroySurface(surface);
+    if (converted == nullptr) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to import %s: %s", path.string().c_str(), SDL_GetError());
+        return std::nullopt;
+    }
+
+    auto const width = converted->w;
+    auto const height = converted->h;
+    std::vector<std::uint32_t> pixels(static_cast<std::size_t>(width) * height);
+
+    for (int y = 0; y < height; ++y) {
+        auto const* const row = static_cast<std::uint8_t const*>(converted->pixels) + static_cast<std::size_t>(y) * converted->pitch;
+        std::memcpy(pixels.data() + static_cast<std::size_t>(y) * width, row, static_cast<std::size_t>(width) * sizeof(std::uint32_t));
+    }
+    SDL_DestroySurface(converted);
+
+    if (pixels.empty()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to import %s: empty image", path.string().c_str());
+        return std::nullopt;
+    }
+
+    return Texture(width, height, pixels);
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vcam/render/texture.hh>
+
+#include <filesystem>
+#include <optional>
+
+namespace vcam {
+
+// Reads a BMP file as an sRGB texture, or returns nothing if it can't be
+// read, logging why. Any pixel format SDL reads is converted.
+std::optional<Texture> import_bmp(std::filesystem::path const& path);
+
+}
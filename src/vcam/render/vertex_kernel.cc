@@ -0,0 +1,240 @@
+#include <vcam/core/simd.hh>
+#include <vcam/render/vertex_kernel.hh>
+
+#include <SDL3/SDL_cpuinfo.h>
+
+#include <array>
+
+namespace vcam {
+
+static std::uint16_t calculate_outcode(glm::vec4 const& v, glm::vec2 const& viewport_size) {
+    std::uint16_t outcode = 0;
+    for (int p = ClipPlane::LEFT; p <= ClipPlane::GUARD_BAND_TOP; ++p) {
+        if (calculate_clip_distance(v, static_cast<ClipPlane>(p), viewport_size) < 0.0f) {
+            outcode |= outcode_bit(static_cast<ClipPlane>(p));
+        }
+    }
+    return outcode;
+}
+
+static void transform_vertex_range(
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    PositionStreams const& positions,
+    ScreenVertexStreams const& vertices,
+    std::uint16_t* outcodes,
+    std::size_t begin
+) {
+    auto const count = positions.x.size();
+    for (auto i = begin; i < count; ++i) {
+        auto const position = glm::vec4(positions.x[i], positions.y[i], positions.z[i], 1.0f);
+        auto const vertex = model_to_viewport_transform * position;
+
+        outcodes[i] = calculate_outcode(vertex, viewport_size);
+
+        auto const inv_w = 1.0f / vertex.w;
+        vertices.x[i] = vertex.x * inv_w;
+        vertices.y[i] = vertex.y * inv_w;
+        vertices.z[i] = vertex.z * inv_w;
+        vertices.inv_w[i] = inv_w;
+    }
+}
+
+static void transform_vertices_scalar(
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    PositionStreams const& positions,
+    ScreenVertexStreams const& vertices,
+    std::uint16_t* outcodes
+) {
+    transform_vertex_range(model_to_viewport_transform, viewport_size, positions, vertices, outcodes, 0);
+}
+
+#ifdef VCAM_X86
+
+// Plane distances are evaluated with the same operations, in the same order,
+// as calculate_clip_distance so that both agree on which side a vertex lies.
+struct OutcodeConstants {
+    float width;
+    float height;
+    float guard_band_near_x;
+    float guard_band_far_x;
+    float guard_band_near_y;
+    float guard_band_far_y;
+};
+
+static OutcodeConstants calculate_outcode_constants(glm::vec2 const& viewport_size) {
+    auto const guard_band_near = (GUARD_BAND - 1.0f) * 0.5f;
+    auto const guard_band_far = (GUARD_BAND + 1.0f) * 0.5f;
+
+    return {
+        viewport_size.x,
+        viewport_size.y,
+        guard_band_near * viewport_size.x,
+        guard_band_far * viewport_size.x,
+        guard_band_near * viewport_size.y,
+        guard_band_far * viewport_size.y
+    };
+}
+
+// One row of the matrix product, summed in the same order as glm's.
+static __m128 transform_row_sse(glm::mat4 const& m, int row, __m128 x, __m128 y, __m128 z) {
+    auto result = _mm_mul_ps(_mm_set1_ps(m[0][row]), x);
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m[1][row]), y));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(m[2][row]), z));
+    return _mm_add_ps(result, _mm_set1_ps(m[3][row]));
+}
+
+static __m128i calculate_outcode_bit_sse(__m128 distance, ClipPlane plane) {
+    auto const outside = _mm_castps_si128(_mm_cmplt_ps(distance, _mm_setzero_ps()));
+    return _mm_and_si128(outside, _mm_set1_epi32(outcode_bit(plane)));
+}
+
+static void transform_vertices_sse(
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    PositionStreams const& positions,
+    ScreenVertexStreams const& vertices,
+    std::uint16_t* outcodes
+) {
+    auto const& m = model_to_viewport_transform;
+    auto const constants = calculate_outcode_constants(viewport_size);
+
+    auto const width = _mm_set1_ps(constants.width);
+    auto const height = _mm_set1_ps(constants.height);
+    auto const guard_band_near_x = _mm_set1_ps(constants.guard_band_near_x);
+    auto const guard_band_far_x = _mm_set1_ps(constants.guard_band_far_x);
+    auto const guard_band_near_y = _mm_set1_ps(constants.guard_band_near_y);
+    auto const guard_band_far_y = _mm_set1_ps(constants.guard_band_far_y);
+    auto const one = _mm_set1_ps(1.0f);
+
+    std::array<std::int32_t, 4> lane_outcodes;
+
+    auto const count = positions.x.size();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto const px = _mm_loadu_ps(positions.x.data() + i);
+        auto const py = _mm_loadu_ps(positions.y.data() + i);
+        auto const pz = _mm_loadu_ps(positions.z.data() + i);
+
+        auto const x = transform_row_sse(m, 0, px, py, pz);
+        auto const y = transform_row_sse(m, 1, px, py, pz);
+        auto const z = transform_row_sse(m, 2, px, py, pz);
+        auto const w = transform_row_sse(m, 3, px, py, pz);
+
+        auto outcode = calculate_outcode_bit_sse(x, ClipPlane::LEFT);
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_sub_ps(_mm_mul_ps(width, w), x), ClipPlane::RIGHT));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_sub_ps(_mm_mul_ps(height, w), y), ClipPlane::BOTTOM));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(y, ClipPlane::TOP));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_add_ps(z, w), ClipPlane::NEAR));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_sub_ps(w, z), ClipPlane::FAR));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_add_ps(x, _mm_mul_ps(guard_band_near_x, w)), ClipPlane::GUARD_BAND_LEFT));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_sub_ps(_mm_mul_ps(guard_band_far_x, w), x), ClipPlane::GUARD_BAND_RIGHT));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_sub_ps(_mm_mul_ps(guard_band_far_y, w), y), ClipPlane::GUARD_BAND_BOTTOM));
+        outcode = _mm_or_si128(outcode, calculate_outcode_bit_sse(_mm_add_ps(y, _mm_mul_ps(guard_band_near_y, w)), ClipPlane::GUARD_BAND_TOP));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_outcodes.data()), outcode);
+        for (std::size_t lane = 0; lane < lane_outcodes.size(); ++lane) {
+            outcodes[i + lane] = static_cast<std::uint16_t>(lane_outcodes[lane]);
+        }
+
+        auto const inv_w = _mm_div_ps(one, w);
+        _mm_storeu_ps(vertices.x + i, _mm_mul_ps(x, inv_w));
+        _mm_storeu_ps(vertices.y + i, _mm_mul_ps(y, inv_w));
+        _mm_storeu_ps(vertices.z + i, _mm_mul_ps(z, inv_w));
+        _mm_storeu_ps(vertices.inv_w + i, inv_w);
+    }
+
+    transform_vertex_range(model_to_viewport_transform, viewport_size, positions, vertices, outcodes, i);
+}
+
+VCAM_TARGET_AVX2
+static __m256 transform_row_avx2(glm::mat4 const& m, int row, __m256 x, __m256 y, __m256 z) {
+    auto result = _mm256_mul_ps(_mm256_set1_ps(m[0][row]), x);
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(m[1][row]), y));
+    result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_set1_ps(m[2][row]), z));
+    return _mm256_add_ps(result, _mm256_set1_ps(m[3][row]));
+}
+
+VCAM_TARGET_AVX2
+static __m256i calculate_outcode_bit_avx2(__m256 distance, ClipPlane plane) {
+    auto const outside = _mm256_castps_si256(_mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_and_si256(outside, _mm256_set1_epi32(outcode_bit(plane)));
+}
+
+VCAM_TARGET_AVX2
+static void transform_vertices_avx2(
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    PositionStreams const& positions,
+    ScreenVertexStreams const& vertices,
+    std::uint16_t* outcodes
+) {
+    auto const& m = model_to_viewport_transform;
+    auto const constants = calculate_outcode_constants(viewport_size);
+
+    auto const width = _mm256_set1_ps(constants.width);
+    auto const height = _mm256_set1_ps(constants.height);
+    auto const guard_band_near_x = _mm256_set1_ps(constants.guard_band_near_x);
+    auto const guard_band_far_x = _mm256_set1_ps(constants.guard_band_far_x);
+    auto const guard_band_near_y = _mm256_set1_ps(constants.guard_band_near_y);
+    auto const guard_band_far_y = _mm256_set1_ps(constants.guard_band_far_y);
+    auto const one = _mm256_set1_ps(1.0f);
+
+    std::array<std::int32_t, 8> lane_outcodes;
+
+    auto const count = positions.x.size();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto const px = _mm256_loadu_ps(positions.x.data() + i);
+        auto const py = _mm256_loadu_ps(positions.y.data() + i);
+        auto const pz = _mm256_loadu_ps(positions.z.data() + i);
+
+        auto const x = transform_row_avx2(m, 0, px, py, pz);
+        auto const y = transform_row_avx2(m, 1, px, py, pz);
+        auto const z = transform_row_avx2(m, 2, px, py, pz);
+        auto const w = transform_row_avx2(m, 3, px, py, pz);
+
+        auto outcode = calculate_outcode_bit_avx2(x, ClipPlane::LEFT);
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_sub_ps(_mm256_mul_ps(width, w), x), ClipPlane::RIGHT));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_sub_ps(_mm256_mul_ps(height, w), y), ClipPlane::BOTTOM));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(y, ClipPlane::TOP));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_add_ps(z, w), ClipPlane::NEAR));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_sub_ps(w, z), ClipPlane::FAR));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_add_ps(x, _mm256_mul_ps(guard_band_near_x, w)), ClipPlane::GUARD_BAND_LEFT));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_sub_ps(_mm256_mul_ps(guard_band_far_x, w), x), ClipPlane::GUARD_BAND_RIGHT));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_sub_ps(_mm256_mul_ps(guard_band_far_y, w), y), ClipPlane::GUARD_BAND_BOTTOM));
+        outcode = _mm256_or_si256(outcode, calculate_outcode_bit_avx2(_mm256_add_ps(y, _mm256_mul_ps(guard_band_near_y, w)), ClipPlane::GUARD_BAND_TOP));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_outcodes.data()), outcode);
+        for (std::size_t lane = 0; lane < lane_outcodes.size(); ++lane) {
+            outcodes[i + lane] = static_cast<std::uint16_t>(lane_outcodes[lane]);
+        }
+
+        auto const inv_w = _mm256_div_ps(one, w);
+        _mm256_storeu_ps(vertices.x + i, _mm256_mul_ps(x, inv_w));
+        _mm256_storeu_ps(vertices.y + i, _mm256_mul_ps(y, inv_w));
+        _mm256_storeu_ps(vertices.z + i, _mm256_mul_ps(z, inv_w));
+        _mm256_storeu_ps(vertices.inv_w + i, inv_w);
+    }
+
+    transform_vertex_range(model_to_viewport_transform, viewport_size, positions, vertices, outcodes, i);
+}
+
+#endif
+
+VertexKernel select_vertex_kernel() {
+#ifdef VCAM_X86
+    if (SDL_HasAVX2()) {
+        return transform_vertices_avx2;
+    }
+
+    if (SDL_HasSSE2()) {
+        return transform_vertices_sse;
+    }
+#endif
+
+    return transform_vertices_scalar;
+}
+
+}
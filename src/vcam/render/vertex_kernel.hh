@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vcam/render/model.hh>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vcam {
+
+enum ClipPlane {
+    LEFT,
+    RIGHT,
+    BOTTOM,
+    TOP,
+    NEAR,
+    FAR,
+    GUARD_BAND_LEFT,
+    GUARD_BAND_RIGHT,
+    GUARD_BAND_BOTTOM,
+    GUARD_BAND_TOP
+};
+
+// Extent of the guard band in normalized device coordinates, where the
+// screen spans -1 to 1, so triangles may extend GUARD_BAND - 1 half-viewports
+// past each screen edge before they get clipped; with 4, the band spans
+// -1.5 to 2.5 viewports. The rasterizer's bounding box clamp handles the
+// rest. Only the near and far planes always need real clipping.
+constexpr float GUARD_BAND = 4.0f;
+
+constexpr std::uint16_t outcode_bit(ClipPlane plane) {
+    return static_cast<std::uint16_t>(1u << plane);
+}
+
+// Signed distance of a vertex in homogeneous viewport space, i.e. with the
+// viewport transform applied before the perspective divide, from a clipping
+// plane. It's only proportional to the distance in clip space, but it has the
+// same sign and intersects edges at the same parameter.
+inline float calculate_clip_distance(glm::vec4 const& v, ClipPlane plane, glm::vec2 const& viewport_size) {
+    auto const guard_band_near = (GUARD_BAND - 1.0f) * 0.5f;
+    auto const guard_band_far = (GUARD_BAND + 1.0f) * 0.5f;
+
+    switch (plane) {
+    case ClipPlane::LEFT:   return v.x;
+    case ClipPlane::RIGHT:  return viewport_size.x * v.w - v.x;
+    case ClipPlane::BOTTOM: return viewport_size.y * v.w - v.y;
+    case ClipPlane::TOP:    return v.y;
+    case ClipPlane::NEAR:   return v.z + v.w;
+    case ClipPlane::FAR:    return v.w - v.z;
+    case ClipPlane::GUARD_BAND_LEFT:   return v.x + guard_band_near * viewport_size.x * v.w;
+    case ClipPlane::GUARD_BAND_RIGHT:  return guard_band_far * viewport_size.x * v.w - v.x;
+    case ClipPlane::GUARD_BAND_BOTTOM: return guard_band_far * viewport_size.y * v.w - v.y;
+    case ClipPlane::GUARD_BAND_TOP:    return v.y + guard_band_near * viewport_size.y * v.w;
+    }
+    return 0.0f;
+}
+
+// Output of the vertex stage, one array per coordinate. Vertices are stored
+// in screen space as (x / w, y / w, z / w, 1 / w).
+struct ScreenVertexStreams {
+    float* x;
+    float* y;
+    float* z;
+    float* inv_w;
+};
+
+// Transforms every position by the combined model to homogeneous viewport
+// transform, writes its screen space coordinates and one bit per ClipPlane it
+// lies outside of to outcodes.
+using VertexKernel = void (*)(
+    glm::mat4 const& model_to_viewport_transform,
+    glm::vec2 const& viewport_size,
+    PositionStreams const& positions,
+    ScreenVertexStreams const& vertices,
+    std::uint16_t* outcodes
+);
+
+// Picks the widest kernel the running CPU supports.
+VertexKernel select_vertex_kernel();
+
+}
@@ -0,0 +1,104 @@
+#include <vcam/render/window_render_target.hh>
+
+#include <SDL3/SDL_log.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace vcam {
+
+WindowRenderTarget::~WindowRenderTarget() {
+    if (m_texture != nullptr) {
+        SDL_DestroyTexture(m_texture);
+    }
+}
+
+Framebuffer WindowRenderTarget::begin_frame() {
+    int width, height;
+    SDL_GetRenderOutputSize(m_renderer, &width, &height);
+
+    if (width != m_width || height != m_height || m_texture == nullptr) {
+        if (m_texture != nullptr) {
+            SDL_DestroyTexture(m_texture);
+            m_texture = nullptr;
+        }
+
+        m_width = width;
+        m_height = height;
+
+        if (width > 0 && height > 0) {
+            m_texture = SDL_CreateTexture(
+                m_renderer,
+                SDL_PIXELFORMAT_RGBA8888,
+                SDL_TEXTUREACCESS_STREAMING,
+                width,
+                height
+            );
+            if (m_texture == nullptr) {
+                SDL_LogError(
+                    SDL_LOG_CATEGORY_APPLICATION,
+                    "Failed to create texture: %s",
+                    SDL_GetError()
+                );
+            }
+        }
+    }
+
+    void* pixels = nullptr;
+    int pitch = 0;
+    m_locked = m_texture != nullptr && SDL_LockTexture(m_texture, nullptr, &pixels, &pitch);
+    if (!m_locked) {
+        return { nullptr, 0, 0, 0 };
+    }
+
+    return {
+        static_cast<std::uint32_t*>(pixels),
+        pitch / static_cast<int>(sizeof(std::uint32_t)),
+        width,
+        height
+    };
+}
+
+void WindowRenderTarget::end_frame() {
+    if (m_locked) {
+        SDL_UnlockTexture(m_texture);
+        m_locked = false;
+
+        SDL_RenderTexture(m_renderer, m_texture, nullptr, nullptr);
+    }
+
+    draw_overlay();
+
+    SDL_RenderPresent(m_renderer);
+}
+
+// Text goes on an opaque background, so it stays readable over any frame.
+void WindowRenderTarget::draw_overlay() {
+    if (m_overlay.empty()) {
+        return;
+    }
+
+    constexpr auto character_size = static_cast<float>(SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE);
+    constexpr auto line_height = character_size * 1.5f;
+
+    std::size_t longest_line = 0;
+    for (auto const& line : m_overlay) {
+        longest_line = std::max(longest_line, line.size());
+    }
+
+    SDL_FRect const background = {
+        0.0f,
+        0.0f,
+        (longest_line + 2) * character_size,
+        m_overlay.size() * line_height + character_size
+    };
+    SDL_SetRenderDrawColor(m_renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderFillRect(m_renderer, &background);
+
+    SDL_SetRenderDrawColor(m_renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+    for (std::size_t i = 0; i < m_overlay.size(); ++i) {
+        SDL_RenderDebugText(m_renderer, character_size, character_size + i * line_height, m_overlay[i].c_str());
+    }
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vcam/render/render_target.hh>
+
+#include <SDL3/SDL_render.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vcam {
+
+// Presents frames through a single streaming texture which is only
+// recreated when the output size changes. The texture is locked for the
+// whole frame, so rasterizers write straight into its memory.
+class WindowRenderTarget : public IRenderTarget {
+public:
+    explicit WindowRenderTarget(SDL_Renderer* renderer)
+        : m_renderer(renderer) { }
+
+    ~WindowRenderTarget();
+
+    WindowRenderTarget(WindowRenderTarget const& other) = delete;
+    WindowRenderTarget& operator=(WindowRenderTarget const& other) = delete;
+
+    virtual Framebuffer begin_frame() override;
+    virtual void end_frame() override;
+
+    // Lines of text drawn over every frame presented from now on, in the
+    // top left corner. No lines hide the overlay.
+    void overlay(std::vector<std::string> lines) {
+        m_overlay = std::move(lines);
+    }
+
+private:
+    SDL_Renderer* m_renderer;
+    SDL_Texture* m_texture = nullptr;
+    int m_width = 0;
+    int m_height = 0;
+    bool m_locked = false;
+    std::vector<std::string> m_overlay;
+
+    void draw_overlay();
+};
+
+}